@@ -0,0 +1,80 @@
+#include <gio-dbus-c++/gio-dbus-c++.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+using namespace Gio::DBus::Details;
+
+namespace {
+
+constexpr size_t ITERATIONS = 20;
+
+template<typename T>
+GVariant *serialize_with_builder(const std::vector<T> &vector)
+{
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, dbus_type_to_variant_type_v<std::vector<T>>);
+
+    for (const T &value: vector) {
+        g_variant_builder_add_value(&builder, DBusSerializer<T>::serialize(value));
+    }
+
+    return g_variant_builder_end(&builder);
+}
+
+template<typename Function>
+double measure_ms(Function &&function)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < ITERATIONS; ++i) {
+        g_variant_unref(g_variant_ref_sink(function(i)));
+    }
+
+    const auto duration = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(duration).count() / ITERATIONS;
+}
+
+template<typename T>
+void benchmark(size_t size)
+{
+    std::vector<T> vector(size);
+    std::iota(vector.begin(), vector.end(), T(0));
+
+    std::vector<std::vector<T>> copies(ITERATIONS, vector);
+
+    const double builder = measure_ms([&](size_t) {
+        return serialize_with_builder(vector);
+    });
+
+    const double fixed = measure_ms([&](size_t) {
+        return DBusSerializer<std::vector<T>>::serialize(vector);
+    });
+
+    const double moved = measure_ms([&](size_t i) {
+        return DBusSerializer<std::vector<T>>::serialize(std::move(copies[i]));
+    });
+
+    std::cout << std::left << std::setw(10) << DBusType<T>::class_name.data() << std::right
+              << std::setw(10) << size << " elements: builder " << std::setw(10) << builder
+              << " ms, fixed " << std::setw(10) << fixed << " ms, moved " << std::setw(10)
+              << moved << " ms" << std::endl;
+}
+
+} /* namespace */
+
+int main()
+{
+    std::cout << std::fixed << std::setprecision(4);
+
+    for (size_t size: {1'000, 100'000, 1'000'000}) {
+        benchmark<uint8_t>(size);
+        benchmark<int32_t>(size);
+        benchmark<double>(size);
+    }
+
+    return 0;
+}
@@ -0,0 +1,307 @@
+#include <gio-dbus-c++/gio-dbus-c++.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <new>
+#include <string>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+using namespace Gio::DBus;
+using namespace Gio::DBus::Details;
+
+/*
+ * Every C++ heap allocation made by the template layer goes through the global operator new,
+ * so replacing it is enough to count them. GLib allocations made while building GVariants are
+ * not counted, they are a property of GLib and not of the serializer.
+ */
+
+namespace {
+
+std::atomic<size_t> allocations = 0;
+
+void *allocate(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void *pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+
+    throw std::bad_alloc();
+}
+
+} /* namespace */
+
+/* NOLINTBEGIN */
+void *operator new(size_t size)
+{
+    return allocate(size);
+}
+
+void *operator new[](size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+/* NOLINTEND */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto MIN_DURATION = std::chrono::milliseconds(100);
+
+struct Result
+{
+    size_t iterations;
+    double ns_per_op;
+    double allocs_per_op;
+};
+
+template<typename T>
+void keep(const T &value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+/* Doubles the batch until it takes long enough to give stable numbers */
+template<typename Function>
+Result measure(Function &&function)
+{
+    for (size_t iterations = 1;; iterations *= 2) {
+        const size_t allocations_before = allocations.load(std::memory_order_relaxed);
+        const auto start = Clock::now();
+
+        for (size_t i = 0; i < iterations; ++i) {
+            function();
+        }
+
+        const auto duration = Clock::now() - start;
+        const size_t allocations_count =
+            allocations.load(std::memory_order_relaxed) - allocations_before;
+
+        if (duration >= MIN_DURATION) {
+            return {
+                iterations,
+                std::chrono::duration<double, std::nano>(duration).count() / iterations,
+                static_cast<double>(allocations_count) / iterations,
+            };
+        }
+    }
+}
+
+void report(std::string_view type,
+            std::string_view signature,
+            size_t size,
+            size_t bytes,
+            std::string_view operation,
+            const Result &result)
+{
+    const double mb_per_s = bytes ? bytes * 1e3 / result.ns_per_op : 0.0;
+
+    std::cout << "{\"type\":\"" << type << "\",\"signature\":\"" << signature
+              << "\",\"size\":" << size << ",\"bytes\":" << bytes << ",\"operation\":\""
+              << operation << "\",\"iterations\":" << result.iterations
+              << ",\"ns_per_op\":" << result.ns_per_op << ",\"mb_per_s\":" << mb_per_s
+              << ",\"allocs_per_op\":" << result.allocs_per_op << "}" << std::endl;
+}
+
+template<typename T>
+void benchmark(const T &value, size_t size)
+{
+    GVariantUniquePtr serialized(g_variant_ref_sink(DBusSerializer<T>::serialize(value)),
+                                 &g_variant_unref);
+
+    const size_t bytes = g_variant_get_size(serialized.get());
+    const std::string_view type = DBusType<T>::class_name.data();
+    const std::string_view signature = DBusType<T>::name.data();
+
+    report(type, signature, size, bytes, "serialize", measure([&] {
+               g_variant_unref(g_variant_ref_sink(DBusSerializer<T>::serialize(value)));
+           }));
+
+    report(type, signature, size, bytes, "deserialize", measure([&] {
+               keep(DBusDeserializer<T>::deserialize(serialized.get()));
+           }));
+}
+
+/* Wrapping a value into a message or a variant, a value moved into a message has to be copied
+ * first, so the copy alone is reported as well */
+template<typename T>
+void benchmark_wrapping(const T &value, size_t size)
+{
+    GVariantUniquePtr serialized(g_variant_ref_sink(DBusSerializer<T>::serialize(value)),
+                                 &g_variant_unref);
+
+    const size_t bytes = g_variant_get_size(serialized.get());
+    const std::string_view type = DBusType<T>::class_name.data();
+    const std::string_view signature = DBusType<T>::name.data();
+
+    report(type, signature, size, bytes, "message", measure([&] {
+               keep(Message(value));
+           }));
+
+    report(type, signature, size, bytes, "copy", measure([&] {
+               keep(T(value));
+           }));
+
+    report(type, signature, size, bytes, "message-move", measure([&] {
+               T copy = value;
+               keep(Message(std::move(copy)));
+           }));
+
+    report(type, signature, size, bytes, "variant", measure([&] {
+               keep(Variant(value));
+           }));
+}
+
+std::string make_string(size_t size)
+{
+    std::string string(size, '\0');
+
+    for (size_t i = 0; i < size; ++i) {
+        string[i] = static_cast<char>('a' + i % 26);
+    }
+
+    return string;
+}
+
+template<typename T>
+std::vector<T> make_numbers(size_t size)
+{
+    std::vector<T> vector(size);
+
+    for (size_t i = 0; i < size; ++i) {
+        vector[i] = static_cast<T>(i);
+    }
+
+    return vector;
+}
+
+std::vector<std::string> make_strings(size_t size)
+{
+    std::vector<std::string> vector;
+    vector.reserve(size);
+
+    for (size_t i = 0; i < size; ++i) {
+        vector.push_back(make_string(8 + i % 32));
+    }
+
+    return vector;
+}
+
+std::map<std::string, Variant> make_dictionary(size_t size)
+{
+    std::map<std::string, Variant> dictionary;
+
+    for (size_t i = 0; i < size; ++i) {
+        std::string key = "key-" + std::to_string(i);
+
+        switch (i % 3) {
+        case 0:
+            dictionary.emplace(std::move(key), Variant(static_cast<int32_t>(i)));
+            break;
+        case 1:
+            dictionary.emplace(std::move(key), Variant(make_string(16)));
+            break;
+        default:
+            dictionary.emplace(std::move(key), Variant(static_cast<double>(i)));
+            break;
+        }
+    }
+
+    return dictionary;
+}
+
+using Nested = std::tuple<int32_t, std::string, std::tuple<double, std::vector<int32_t>>>;
+
+std::vector<Nested> make_nested(size_t size)
+{
+    std::vector<Nested> vector;
+    vector.reserve(size);
+
+    for (size_t i = 0; i < size; ++i) {
+        vector.emplace_back(static_cast<int32_t>(i),
+                            make_string(16),
+                            std::make_tuple(static_cast<double>(i), make_numbers<int32_t>(4)));
+    }
+
+    return vector;
+}
+
+std::vector<Variant> make_variants(size_t size)
+{
+    std::vector<Variant> vector;
+    vector.reserve(size);
+
+    for (size_t i = 0; i < size; ++i) {
+        vector.emplace_back(static_cast<int64_t>(i));
+    }
+
+    return vector;
+}
+
+} /* namespace */
+
+int main()
+{
+    benchmark<bool>(true, 1);
+    benchmark<uint8_t>(42, 1);
+    benchmark<int16_t>(-42, 1);
+    benchmark<uint16_t>(42, 1);
+    benchmark<int32_t>(-42, 1);
+    benchmark<uint32_t>(42, 1);
+    benchmark<uint64_t>(42, 1);
+    benchmark<double>(42.0, 1);
+    benchmark(UnixFD(0), 1);
+    benchmark(ObjectPath("/org/example/Object"), 1);
+    benchmark(Signature("a{sv}"), 1);
+    benchmark(Variant(42), 1);
+    benchmark(std::variant<int32_t, std::string>(make_string(16)), 1);
+    benchmark(std::array<int32_t, 16>{}, 16);
+
+    for (size_t size: {16, 1'024, 65'536}) {
+        benchmark(make_string(size), size);
+        benchmark(make_numbers<uint8_t>(size), size);
+        benchmark(make_numbers<int32_t>(size), size);
+
+        benchmark_wrapping(make_string(size), size);
+        benchmark_wrapping(make_numbers<int32_t>(size), size);
+    }
+
+    for (size_t size: {16, 1'024, 16'384}) {
+        benchmark(make_strings(size), size);
+        benchmark(make_dictionary(size), size);
+        benchmark(make_nested(size), size);
+        benchmark(make_variants(size), size);
+
+        benchmark_wrapping(make_strings(size), size);
+    }
+
+    return 0;
+}
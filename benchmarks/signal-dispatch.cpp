@@ -0,0 +1,140 @@
+#include "signal-dispatcher.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace Gio::DBus;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t ITERATIONS = 100'000;
+
+/* The dispatch used before SignalDispatcher, kept as a baseline */
+class LinearDispatcher
+{
+public:
+    size_t subscribe(const std::string &signal_name, SignalDispatcher::Handler handler)
+    {
+        m_entries.push_back({m_next_id, signal_name, std::move(handler)});
+        return m_next_id++;
+    }
+
+    void unsubscribe(size_t id)
+    {
+        m_entries.remove_if([id](const Entry &entry) {
+            return entry.id == id;
+        });
+    }
+
+    template<typename MakeMessage>
+    void dispatch(const char *signal_name, MakeMessage &&make_message)
+    {
+        std::optional<Message> message;
+
+        for (const Entry &entry: m_entries) {
+            if (entry.signal_name == signal_name) {
+                if (!message) {
+                    message = make_message();
+                }
+
+                entry.handler(*message);
+            }
+        }
+    }
+
+private:
+    struct Entry
+    {
+        size_t id;
+        std::string signal_name;
+        SignalDispatcher::Handler handler;
+    };
+
+    size_t m_next_id = 0;
+    std::list<Entry> m_entries;
+};
+
+template<typename Function>
+double measure_ns(size_t iterations, Function &&function)
+{
+    const auto start = Clock::now();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        function();
+    }
+
+    const auto duration = Clock::now() - start;
+    return std::chrono::duration<double, std::nano>(duration).count() / iterations;
+}
+
+void report(std::string_view dispatcher,
+            size_t subscriptions,
+            std::string_view operation,
+            double ns_per_op)
+{
+    std::cout << "{\"dispatcher\":\"" << dispatcher << "\",\"subscriptions\":" << subscriptions
+              << ",\"operation\":\"" << operation << "\",\"ns_per_op\":" << ns_per_op << "}"
+              << std::endl;
+}
+
+/* Every subscription listens to its own signal, so a dispatch calls exactly one handler */
+template<typename Dispatcher>
+void benchmark(std::string_view name, size_t subscriptions)
+{
+    Dispatcher dispatcher;
+    std::vector<size_t> ids;
+    size_t calls = 0;
+
+    const auto make_message = [] {
+        return Message(int32_t(42));
+    };
+
+    const double subscribe = measure_ns(subscriptions, [&] {
+        ids.push_back(dispatcher.subscribe("Signal" + std::to_string(ids.size()),
+                                           [&calls](const Message &) {
+                                               ++calls;
+                                           }));
+    });
+
+    const std::string last = "Signal" + std::to_string(subscriptions - 1);
+
+    const double hit = measure_ns(ITERATIONS, [&] {
+        dispatcher.dispatch(last.c_str(), make_message);
+    });
+
+    const double miss = measure_ns(ITERATIONS, [&] {
+        dispatcher.dispatch("NotSubscribed", make_message);
+    });
+
+    size_t next = 0;
+    const double unsubscribe = measure_ns(subscriptions, [&] {
+        dispatcher.unsubscribe(ids[next++]);
+    });
+
+    if (calls != ITERATIONS) {
+        std::cerr << "Unexpected handler calls count " << calls << std::endl;
+    }
+
+    report(name, subscriptions, "subscribe", subscribe);
+    report(name, subscriptions, "dispatch_hit", hit);
+    report(name, subscriptions, "dispatch_miss", miss);
+    report(name, subscriptions, "unsubscribe", unsubscribe);
+}
+
+} /* namespace */
+
+int main()
+{
+    for (size_t subscriptions: {1, 10, 100, 1'000, 10'000}) {
+        benchmark<LinearDispatcher>("linear", subscriptions);
+        benchmark<SignalDispatcher>("hashed", subscriptions);
+    }
+
+    return 0;
+}
@@ -0,0 +1,243 @@
+#ifndef GIO_DBUS_CPP_COLUMNS_HPP
+#define GIO_DBUS_CPP_COLUMNS_HPP
+
+#include "details/dbus-decode-limits.hpp"
+#include "details/dbus-deserializer.hpp"
+#include "details/dbus-encoder.hpp"
+#include "details/dbus-layout.hpp"
+#include "details/dbus-serializer.hpp"
+#include "details/dbus-type-traits.hpp"
+#include "details/exception.hpp"
+
+#include <array>
+#include <gio/gio.h>
+#include <ranges>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace Gio::DBus {
+
+/* Array of structures a(T...) stored column by column, one std::vector per member of the
+ * structure, e.g. Columns<uint64_t, double> holds a(td) as std::vector<uint64_t> and
+ * std::vector<double>. All columns are expected to have the same size. */
+template<typename... T>
+class Columns: public std::tuple<std::vector<T>...>
+{
+    static_assert(sizeof...(T) > 0, "Gio::DBus::Columns<T...> requires at least one column");
+
+public:
+    using std::tuple<std::vector<T>...>::tuple;
+
+    template<size_t I>
+    auto &column() noexcept
+    {
+        return std::get<I>(*this);
+    }
+
+    template<size_t I>
+    const auto &column() const noexcept
+    {
+        return std::get<I>(*this);
+    }
+
+    size_t size() const noexcept
+    {
+        return std::get<0>(*this).size();
+    }
+
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    std::tuple<typename std::vector<T>::const_reference...> row(size_t index) const noexcept
+    {
+        return std::apply(
+            [index](const std::vector<T> &...columns) {
+                return std::tuple<typename std::vector<T>::const_reference...>(columns[index]...);
+            },
+            static_cast<const std::tuple<std::vector<T>...> &>(*this));
+    }
+
+    bool has_equal_columns() const noexcept
+    {
+        return std::apply(
+            [this](const std::vector<T> &...columns) {
+                return ((columns.size() == size()) && ...);
+            },
+            static_cast<const std::tuple<std::vector<T>...> &>(*this));
+    }
+};
+
+namespace Details {
+
+template<typename... T>
+struct DBusType<Gio::DBus::Columns<T...>>: std::true_type
+{
+    /* clang-format off */
+    static constexpr auto name = "a"_cts + DBusType<std::tuple<T...>>::name;
+    static constexpr auto class_name = "Gio::DBus::Columns<"_cts + DBusType<std::tuple<T...>>::class_name + ">"_cts;
+    /* clang-format on */
+};
+
+template<typename... T>
+struct DBusViewType<Gio::DBus::Columns<T...>>: std::disjunction<DBusViewType<T>...>
+{};
+
+template<typename... T>
+struct DBusSerializer<Gio::DBus::Columns<T...>>
+{
+    using Columns = Gio::DBus::Columns<T...>;
+    using Row = std::tuple<typename std::vector<T>::const_reference...>;
+
+    static GVariant *serialize(const Columns &columns)
+    {
+        if (!columns.has_equal_columns()) {
+            GIO_DBUS_CPP_THROW_ERROR("Attempt to serialize Gio::DBus::Columns whose columns have "
+                                     "different sizes");
+        }
+
+        GVariantBuilder builder;
+        g_variant_builder_init(&builder, dbus_type_to_variant_type_v<Columns>);
+
+        for (size_t index = 0; index < columns.size(); ++index) {
+            g_variant_builder_add_value(&builder,
+                                        DBusSerializer<Row>::serialize(columns.row(index)));
+        }
+
+        return g_variant_builder_end(&builder);
+    }
+};
+
+/* Rows are encoded one by one straight from the columns */
+template<typename... T>
+struct DBusEncoder<Gio::DBus::Columns<T...>>
+{
+    using Columns = Gio::DBus::Columns<T...>;
+
+    static size_t size(const Columns &columns)
+    {
+        if (!columns.has_equal_columns()) {
+            GIO_DBUS_CPP_THROW_ERROR("Attempt to encode Gio::DBus::Columns whose columns have "
+                                     "different sizes");
+        }
+
+        return Encoder::size(rows(columns));
+    }
+
+    static size_t encode(const Columns &columns, char *data)
+    {
+        return Encoder::encode(rows(columns), data);
+    }
+
+private:
+    using Row = std::tuple<typename std::vector<T>::const_reference...>;
+
+    static auto rows(const Columns &columns) noexcept
+    {
+        return std::views::iota(size_t(0), columns.size())
+               | std::views::transform([&columns](size_t index) { return columns.row(index); });
+    }
+
+    using Encoder = DBusArrayEncoder<decltype(rows(std::declval<const Columns &>())),
+                                     DBusElementEncoder<Row>>;
+};
+
+/* Arrays of fixed-size structures are stored as rows of the same stride, so every column is
+ * filled by a single strided loop over the serialized data without creating a GVariant per
+ * row or member. Other arrays are decoded row by row. */
+template<typename... T>
+struct DBusDeserializer<Gio::DBus::Columns<T...>>
+{
+    using Columns = Gio::DBus::Columns<T...>;
+
+    static Columns deserialize(GVariant *message)
+    {
+        Columns columns;
+        deserialize_into(message, columns);
+
+        return columns;
+    }
+
+    static void deserialize_into(GVariant *message, Columns &columns)
+    {
+        if constexpr (is_dbus_fixed_layout_v<std::tuple<T...>>) {
+            const size_t size = g_variant_get_size(message);
+
+            if (size % stride == 0) {
+                dbus_decode_elements(size / stride);
+                dbus_decode_bytes(size);
+
+                scatter(static_cast<const char *>(g_variant_get_data(message)),
+                        size / stride,
+                        columns,
+                        std::index_sequence_for<T...>());
+                return;
+            }
+        }
+
+        implementation(message, columns, std::index_sequence_for<T...>());
+    }
+
+private:
+    static constexpr size_t stride = dbus_layout_v<std::tuple<T...>>.fixed_size;
+    static constexpr std::array<size_t, sizeof...(T)> offsets = dbus_struct_offsets<T...>();
+
+    template<size_t... I>
+    static void scatter(const char *data,
+                        size_t rows,
+                        Columns &columns,
+                        std::index_sequence<I...>) noexcept
+    {
+        (scatter_column(data + offsets[I], rows, std::get<I>(columns)), ...);
+    }
+
+    template<typename C>
+    static void scatter_column(const char *data, size_t rows, std::vector<C> &column) noexcept
+    {
+        column.resize(rows);
+
+        if constexpr (std::is_same_v<C, bool>) {
+            for (size_t row = 0; row < rows; ++row, data += stride) {
+                column[row] = DBusFixedLayout<C>::read(data);
+            }
+        } else {
+            C *values = column.data();
+
+            for (size_t row = 0; row < rows; ++row, data += stride) {
+                values[row] = DBusFixedLayout<C>::read(data);
+            }
+        }
+    }
+
+    template<size_t... I>
+    static void implementation(GVariant *message, Columns &columns, std::index_sequence<I...>)
+    {
+        const DBusDecodeDepth depth;
+        const size_t rows = g_variant_n_children(message);
+        dbus_decode_elements(rows);
+
+        ((std::get<I>(columns).clear(), std::get<I>(columns).reserve(rows)), ...);
+
+        GVariantIter iterator;
+        g_variant_iter_init(&iterator, message);
+
+        GVariant *row = nullptr;
+
+        while ((row = g_variant_iter_next_value(&iterator))) {
+            GVariantUniquePtr owned_row(row, &g_variant_unref);
+
+            (std::get<I>(columns).emplace_back(DBusDeserializer<T>::deserialize(
+                 GVariantUniquePtr(g_variant_get_child_value(row, I), &g_variant_unref).get())),
+             ...);
+        }
+    }
+};
+
+} /* namespace Details */
+
+} /* namespace Gio::DBus */
+
+#endif /* GIO_DBUS_CPP_COLUMNS_HPP */
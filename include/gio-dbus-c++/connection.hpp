@@ -3,8 +3,14 @@
 
 #include "common.hpp"
 #include "connection-type.hpp"
+#include "error.hpp"
 #include "gio-types.hpp"
+#include "message.hpp"
+#include "signal-match.hpp"
+#include "subscription.hpp"
+#include "timeout.hpp"
 
+#include "details/dbus-type-traits.hpp"
 #include "details/pimpl.hpp"
 
 #include <functional>
@@ -28,7 +34,70 @@ public:
     const std::string &unique_name() const noexcept;
     const std::string &name() const noexcept;
 
+    /* Marks the peer of a peer-to-peer connection as trusted, e.g. our own service on a private
+     * connection, throws Gio::DBus::Error for bus connections. Replies and signals received
+     * from it are read without type checks in release builds, debug builds still check them.
+     * Proxies copy the flag when they are created. */
+    void set_trusted_peer(bool trusted);
+    bool is_trusted_peer() const noexcept;
+
+    /* Receives the signals matching the match rule installed on the bus, unlike
+     * Proxy::subscribe_to_signal which receives every signal of the proxy interface and filters
+     * them in the process. Matches on object_namespace or on arguments after the first one are
+     * also checked in the process, as GDBus can't match on them itself. */
+    Subscription subscribe_to_signal(const SignalMatch &match,
+                                     std::function<void(const Message &)> on_signal_emitted);
+    void unsubscribe_from_signal(const Subscription &subscription) noexcept;
+
+    /* Calls a method without creating a proxy, which costs a single message round trip and
+     * suits one-off calls. Replies are read as replies of a proxy without decode limits. The
+     * service is empty on peer-to-peer connections, which have no bus to route the call. */
+    Message call(const std::string &service,
+                 const std::string &object,
+                 const std::string &interface,
+                 const std::string &method,
+                 const Timeout &timeout = Timeout::Default) const;
+    Message call(const std::string &service,
+                 const std::string &object,
+                 const std::string &interface,
+                 const std::string &method,
+                 const Message &arguments,
+                 const Timeout &timeout = Timeout::Default) const;
+
+    /* Passes each value as a separate argument, as Proxy::call does */
+    template<typename... Args>
+        requires(sizeof...(Args) > 0 && (Details::is_dbus_type_v<Args> && ...))
+    Message call(const std::string &service,
+                 const std::string &object,
+                 const std::string &interface,
+                 const std::string &method,
+                 const Args &...arguments) const
+    {
+        if constexpr (sizeof...(Args) == 1) {
+            return call(service, object, interface, method, Message(arguments...));
+        } else {
+            return call(service, object, interface, method, Message::from(arguments...));
+        }
+    }
+
+    void call_async(const std::string &service,
+                    const std::string &object,
+                    const std::string &interface,
+                    const std::string &method,
+                    const std::function<void(const Message &)> &on_success,
+                    const std::function<void(const Error &)> &on_error,
+                    const Timeout &timeout = Timeout::Default) const;
+    void call_async(const std::string &service,
+                    const std::string &object,
+                    const std::string &interface,
+                    const std::string &method,
+                    const Message &arguments,
+                    const std::function<void(const Message &)> &on_success,
+                    const std::function<void(const Error &)> &on_error,
+                    const Timeout &timeout = Timeout::Default) const;
+
 private:
+    friend class ConnectionImpl;
     friend class ProxyImpl;
     GDBusConnection *as_gio_connection() const noexcept;
 };
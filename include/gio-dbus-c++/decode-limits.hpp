@@ -0,0 +1,30 @@
+#ifndef GIO_DBUS_CPP_DECODE_LIMITS_HPP
+#define GIO_DBUS_CPP_DECODE_LIMITS_HPP
+
+#include <cstddef>
+#include <limits>
+
+namespace Gio::DBus {
+
+/* Upper bounds of what reading a single value may materialize, a value exceeding any of them
+ * fails with Gio::DBus::Error before the memory for it is allocated. Elements are counted over
+ * all arrays and dictionaries of the value, bytes over all strings and arrays of fixed-size
+ * basic types, depth is the nesting of the arrays, dictionaries and structures decoded
+ * including the structure of the message arguments. */
+struct DecodeLimits
+{
+    static inline constexpr size_t Unlimited = std::numeric_limits<size_t>::max();
+
+    size_t max_elements = Unlimited;
+    size_t max_bytes = Unlimited;
+    size_t max_depth = Unlimited;
+
+    bool is_unlimited() const noexcept
+    {
+        return max_elements == Unlimited && max_bytes == Unlimited && max_depth == Unlimited;
+    }
+};
+
+} /* namespace Gio::DBus */
+
+#endif /* GIO_DBUS_CPP_DECODE_LIMITS_HPP */
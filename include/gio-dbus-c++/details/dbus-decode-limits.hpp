@@ -0,0 +1,175 @@
+#ifndef GIO_DBUS_CPP_DETAILS_DBUS_DECODE_LIMITS_HPP
+#define GIO_DBUS_CPP_DETAILS_DBUS_DECODE_LIMITS_HPP
+
+#include "exception.hpp"
+
+#include "../decode-limits.hpp"
+
+#include <string>
+
+namespace Gio::DBus::Details {
+
+/* What the value being decoded on the current thread has materialized so far */
+struct DBusDecodeContext
+{
+    DecodeLimits limits;
+    size_t elements;
+    size_t bytes;
+    size_t depth;
+};
+
+inline thread_local DBusDecodeContext *dbus_decode_context = nullptr;
+
+/* Enforces the limits while decoding a value on the current thread, nested scopes take over
+ * until they are destroyed. Unlimited scopes leave the deserializers without any checks. */
+class DBusDecodeScope
+{
+public:
+    explicit DBusDecodeScope(const DecodeLimits &limits) noexcept
+        : m_context{limits, 0, 0, 0}
+        , m_previous(dbus_decode_context)
+    {
+        dbus_decode_context = limits.is_unlimited() ? nullptr : &m_context;
+    }
+
+    DBusDecodeScope(const DBusDecodeScope &) = delete;
+    DBusDecodeScope &operator=(const DBusDecodeScope &) = delete;
+
+    ~DBusDecodeScope()
+    {
+        dbus_decode_context = m_previous;
+    }
+
+private:
+    DBusDecodeContext m_context;
+    DBusDecodeContext *m_previous;
+};
+
+/* Limits left to the value being decoded on the current thread, a Gio::DBus::Variant decoded
+ * as a part of it keeps them for reading its own value later */
+inline DecodeLimits dbus_decode_remaining_limits() noexcept
+{
+    const DBusDecodeContext *context = dbus_decode_context;
+
+    if (!context) {
+        return {};
+    }
+
+    auto remaining = [](size_t limit, size_t used) {
+        return limit == DecodeLimits::Unlimited ? limit : limit - used;
+    };
+
+    return {remaining(context->limits.max_elements, context->elements),
+            remaining(context->limits.max_bytes, context->bytes),
+            remaining(context->limits.max_depth, context->depth)};
+}
+
+/* Limits of a part nested one level below a value read within the limits, e.g. an element of
+ * an array read on its own later */
+inline DecodeLimits dbus_nested_limits(DecodeLimits limits) noexcept
+{
+    if (limits.max_depth != DecodeLimits::Unlimited && limits.max_depth > 0) {
+        --limits.max_depth;
+    }
+
+    return limits;
+}
+
+/* Remembers the elements and bytes decoded so far, a part that is decoded again from scratch
+ * after an abandoned attempt rolls back to it so that it is accounted only once */
+class DBusDecodeCheckpoint
+{
+public:
+    DBusDecodeCheckpoint() noexcept
+        : m_context(dbus_decode_context)
+        , m_elements(m_context ? m_context->elements : 0)
+        , m_bytes(m_context ? m_context->bytes : 0)
+    {}
+
+    void rollback() const noexcept
+    {
+        if (m_context) {
+            m_context->elements = m_elements;
+            m_context->bytes = m_bytes;
+        }
+    }
+
+private:
+    DBusDecodeContext *m_context;
+    size_t m_elements;
+    size_t m_bytes;
+};
+
+/* Called with the number of elements of an array or a dictionary before it is allocated */
+inline void dbus_decode_elements(size_t count)
+{
+    DBusDecodeContext *context = dbus_decode_context;
+
+    if (!context) {
+        return;
+    }
+
+    if (count > context->limits.max_elements - context->elements) {
+        GIO_DBUS_CPP_THROW_ERROR("Attempt to decode more than "
+                                 + std::to_string(context->limits.max_elements)
+                                 + " array or dictionary elements, the decode limit is exceeded");
+    }
+
+    context->elements += count;
+}
+
+/* Called with the size of a string or an array of fixed-size basic types before it is copied */
+inline void dbus_decode_bytes(size_t size)
+{
+    DBusDecodeContext *context = dbus_decode_context;
+
+    if (!context) {
+        return;
+    }
+
+    if (size > context->limits.max_bytes - context->bytes) {
+        GIO_DBUS_CPP_THROW_ERROR("Attempt to decode more than "
+                                 + std::to_string(context->limits.max_bytes)
+                                 + " bytes of strings and arrays, the decode limit is exceeded");
+    }
+
+    context->bytes += size;
+}
+
+/* Counts one level of nesting for its lifetime */
+class DBusDecodeDepth
+{
+public:
+    DBusDecodeDepth()
+        : m_context(dbus_decode_context)
+    {
+        if (!m_context) {
+            return;
+        }
+
+        if (m_context->depth == m_context->limits.max_depth) {
+            GIO_DBUS_CPP_THROW_ERROR("Attempt to decode a value nested deeper than "
+                                     + std::to_string(m_context->limits.max_depth)
+                                     + " levels, the decode limit is exceeded");
+        }
+
+        ++m_context->depth;
+    }
+
+    DBusDecodeDepth(const DBusDecodeDepth &) = delete;
+    DBusDecodeDepth &operator=(const DBusDecodeDepth &) = delete;
+
+    ~DBusDecodeDepth()
+    {
+        if (m_context) {
+            --m_context->depth;
+        }
+    }
+
+private:
+    DBusDecodeContext *m_context;
+};
+
+} /* namespace Gio::DBus::Details */
+
+#endif /* GIO_DBUS_CPP_DETAILS_DBUS_DECODE_LIMITS_HPP */
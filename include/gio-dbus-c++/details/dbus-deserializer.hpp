@@ -1,15 +1,30 @@
 #ifndef GIO_DBUS_CPP_DETAILS_DBUS_TYPE_DESERIALIZER_HPP
 #define GIO_DBUS_CPP_DETAILS_DBUS_TYPE_DESERIALIZER_HPP
 
+#include "dbus-decode-limits.hpp"
+#include "dbus-layout.hpp"
+#include "dbus-type-traits.hpp"
+#include "exception.hpp"
+
 #include "../object-path.hpp"
 #include "../signature.hpp"
 #include "../unix-fd.hpp"
 
+#include <array>
+#include <cstring>
+#include <deque>
+#include <functional>
 #include <gio/gio.h>
+#include <map>
 #include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 #include <tuple>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <variant>
 #include <vector>
 
 namespace Gio::DBus::Details {
@@ -18,6 +33,67 @@ template<typename T>
 struct DBusDeserializer
 {};
 
+using GVariantUniquePtr = std::unique_ptr<GVariant, decltype(&g_variant_unref)>;
+
+/* Keeps the children of a GVariant whose values are viewed alive. Children of a GVariant in tree
+ * form, e.g. the body of a message parsed by GDBus, are released once it gets serialized, so
+ * instead of serializing the whole of it, which copies all its data, each child is referenced
+ * and serialized on its own. GDBus already provides strings and fixed arrays serialized, viewing
+ * them copies nothing. */
+inline void dbus_pin_children(GVariant *container, std::vector<GVariantUniquePtr> &children)
+{
+    if (!children.empty()) {
+        return;
+    }
+
+    const size_t size = g_variant_n_children(container);
+    children.reserve(size);
+
+    for (size_t index = 0; index < size; ++index) {
+        GVariantUniquePtr child(g_variant_get_child_value(container, index), &g_variant_unref);
+        g_variant_get_data(child.get());
+        children.push_back(std::move(child));
+    }
+}
+
+/* Reads a value of a fixed layout from a copy of its serialized data on the stack, which
+ * g_variant_store() writes without serializing a GVariant in tree form in place */
+template<typename T>
+T dbus_read_fixed_layout(GVariant *value)
+{
+    alignas(dbus_layout_v<T>.alignment) std::array<char, dbus_layout_v<T>.fixed_size> data;
+    g_variant_store(value, data.data());
+
+    return DBusFixedLayout<T>::read(data.data());
+}
+
+/* Refills an existing value, reusing the memory it already owns where the deserializer
+ * supports it (deserialize_into) and falling back to assigning a new value otherwise */
+template<typename T>
+void dbus_deserialize_into(GVariant *message, T &value)
+{
+    if constexpr (requires { DBusDeserializer<T>::deserialize_into(message, value); }) {
+        DBusDeserializer<T>::deserialize_into(message, value);
+    } else {
+        value = DBusDeserializer<T>::deserialize(message);
+    }
+}
+
+/* Deserializes a value constructed with the allocator of its container, so values nested in
+ * std::pmr containers are allocated from the memory resource of the outermost container */
+template<typename T, typename Allocator>
+T dbus_deserialize_using_allocator(GVariant *message, const Allocator &allocator)
+{
+    if constexpr (std::is_default_constructible_v<T>) {
+        T value = std::make_obj_using_allocator<T>(allocator);
+        dbus_deserialize_into(message, value);
+
+        return value;
+    } else {
+        return DBusDeserializer<T>::deserialize(message);
+    }
+}
+
 template<>
 struct DBusDeserializer<bool>
 {
@@ -99,69 +175,312 @@ struct DBusDeserializer<double>
     }
 };
 
+template<typename Allocator>
+struct DBusDeserializer<std::basic_string<char, std::char_traits<char>, Allocator>>
+{
+    using String = std::basic_string<char, std::char_traits<char>, Allocator>;
+
+    static String deserialize(GVariant *message)
+    {
+        gsize length = 0;
+        const char *string = g_variant_get_string(message, &length);
+        dbus_decode_bytes(length);
+
+        return {string, length};
+    }
+
+    static void deserialize_into(GVariant *message, String &string)
+    {
+        gsize length = 0;
+        const char *data = g_variant_get_string(message, &length);
+        dbus_decode_bytes(length);
+
+        string.assign(data, length);
+    }
+};
+
 template<>
-struct DBusDeserializer<std::string>
+struct DBusDeserializer<std::string_view>
 {
-    static std::string deserialize(GVariant *message)
+    static std::string_view deserialize(GVariant *message) noexcept
+    {
+        gsize length = 0;
+        const char *string = g_variant_get_string(message, &length);
+
+        return {string, length};
+    }
+};
+
+/* Sequence containers (std::vector, std::deque) */
+template<typename Container, typename T>
+struct DBusArrayDeserializer
+{
+    static Container deserialize(GVariant *message)
+    {
+        Container container;
+        deserialize_into(message, container);
+
+        return container;
+    }
+
+    static void deserialize_into(GVariant *message, Container &container)
     {
-        return {g_variant_get_string(message, nullptr)};
+        if constexpr (is_dbus_trivial_type_v<T>) {
+            gsize size = 0;
+            const T *data = static_cast<const T *>(
+                g_variant_get_fixed_array(message, &size, sizeof(T)));
+
+            dbus_decode_elements(size);
+            dbus_decode_bytes(size * sizeof(T));
+
+            container.assign(data, data + size);
+        } else {
+            const DBusDecodeDepth depth;
+            const size_t size = g_variant_n_children(message);
+            dbus_decode_elements(size);
+
+            GVariantIter iterator;
+            g_variant_iter_init(&iterator, message);
+
+            GVariant *entry = nullptr;
+
+            /* Existing elements are refilled in place to reuse the memory of nested strings
+             * and containers, types that cannot be default constructed are appended instead */
+            if constexpr (std::is_default_constructible_v<T> && !std::is_same_v<T, bool>) {
+                container.resize(size);
+
+                for (size_t index = 0; (entry = g_variant_iter_next_value(&iterator)); ++index) {
+                    GVariantUniquePtr owned_entry(entry, &g_variant_unref);
+                    dbus_deserialize_into(entry, container[index]);
+                }
+            } else {
+                container.clear();
+
+                if constexpr (requires { container.reserve(size_t()); }) {
+                    container.reserve(size);
+                }
+
+                while ((entry = g_variant_iter_next_value(&iterator))) {
+                    GVariantUniquePtr owned_entry(entry, &g_variant_unref);
+                    container.emplace_back(DBusDeserializer<T>::deserialize(entry));
+                }
+            }
+        }
     }
 };
 
 template<typename T, typename Allocator>
 struct DBusDeserializer<std::vector<T, Allocator>>
+    : DBusArrayDeserializer<std::vector<T, Allocator>, T>
+{};
+
+template<typename T, typename Allocator>
+struct DBusDeserializer<std::deque<T, Allocator>>
+    : DBusArrayDeserializer<std::deque<T, Allocator>, T>
+{};
+
+/* Fixed-size arrays are filled in place and require the exact number of elements */
+template<typename T, size_t N>
+struct DBusDeserializer<std::array<T, N>>
 {
-    using Vector = std::vector<T, Allocator>;
+    static_assert(std::is_default_constructible_v<T>,
+                  "Only arrays of default constructible types can be deserialized "
+                  "as std::array<T, N>");
 
-    static Vector deserialize(GVariant *message)
+    static std::array<T, N> deserialize(GVariant *message)
     {
-        Vector vector;
-        vector.reserve(g_variant_n_children(message));
-
-        GVariantIter iterator;
-        g_variant_iter_init(&iterator, message);
+        std::array<T, N> array = {};
+        deserialize_into(message, array);
 
-        GVariant *entry = nullptr;
+        return array;
+    }
 
-        while ((entry = g_variant_iter_next_value(&iterator))) {
-            vector.emplace_back(DBusDeserializer<T>::deserialize(entry));
-            g_variant_unref(entry);
+    static void deserialize_into(GVariant *message, std::array<T, N> &array)
+    {
+        if constexpr (is_dbus_trivial_type_v<T>) {
+            gsize size = 0;
+            const void *data = g_variant_get_fixed_array(message, &size, sizeof(T));
+
+            check_size(size);
+            dbus_decode_elements(size);
+            dbus_decode_bytes(size * sizeof(T));
+
+            if (size) {
+                std::memcpy(array.data(), data, size * sizeof(T));
+            }
+        } else {
+            const DBusDecodeDepth depth;
+
+            check_size(g_variant_n_children(message));
+            dbus_decode_elements(N);
+
+            for (size_t index = 0; index < N; ++index) {
+                GVariantUniquePtr entry(g_variant_get_child_value(message, index),
+                                        &g_variant_unref);
+                dbus_deserialize_into(entry.get(), array[index]);
+            }
         }
+    }
 
-        return vector;
+private:
+    static void check_size(size_t size)
+    {
+        if (size != N) {
+            GIO_DBUS_CPP_THROW_ERROR("Attempt to deserialize an array of " + std::to_string(size)
+                                     + " elements as std::array of " + std::to_string(N)
+                                     + " elements");
+        }
     }
 };
 
-template<typename K, typename V, typename Hash, typename Pred, typename Allocator>
-struct DBusDeserializer<std::unordered_map<K, V, Hash, Pred, Allocator>>
+template<typename T>
+struct DBusDeserializer<std::span<const T>>
 {
-    using Map = std::unordered_map<K, V, Hash, Pred, Allocator>;
+    static_assert(is_dbus_trivial_type_v<T>,
+                  "Only arrays of fixed-size basic dbus types except bool can be viewed "
+                  "as std::span<const T>");
+
+    static std::span<const T> deserialize(GVariant *message) noexcept
+    {
+        gsize size = 0;
+        const void *data = g_variant_get_fixed_array(message, &size, sizeof(T));
+
+        return {static_cast<const T *>(data), size};
+    }
+};
 
+/* Dictionaries (std::unordered_map, std::map) */
+template<typename Map, typename K, typename V>
+struct DBusDictDeserializer
+{
     static Map deserialize(GVariant *message)
     {
         Map map;
-        map.reserve(g_variant_n_children(message));
+        deserialize_into(message, map);
+
+        return map;
+    }
+
+    static void deserialize_into(GVariant *message, Map &map)
+    {
+        const DBusDecodeDepth depth;
+        const size_t size = g_variant_n_children(message);
+        dbus_decode_elements(size);
+
+        /* Replies that are read repeatedly usually carry the same keys, so while every key of
+         * the message is already in the map the existing values are refilled in place */
+        if constexpr (std::is_default_constructible_v<K>) {
+            if (map.size() == size) {
+                const DBusDecodeCheckpoint checkpoint;
+
+                if (refill(message, map)) {
+                    return;
+                }
+
+                checkpoint.rollback();
+            }
+        }
+
+        map.clear();
+
+        if constexpr (requires { map.reserve(size); }) {
+            map.reserve(size);
+        }
+
+        GVariantIter iterator;
+        g_variant_iter_init(&iterator, message);
+
+        GVariant *entry = nullptr;
 
+        while ((entry = g_variant_iter_next_value(&iterator))) {
+            GVariantUniquePtr owned_entry(entry, &g_variant_unref);
+            GVariantUniquePtr key(g_variant_get_child_value(entry, 0), &g_variant_unref);
+            GVariantUniquePtr value(g_variant_get_child_value(entry, 1), &g_variant_unref);
+
+            map.emplace(dbus_deserialize_using_allocator<K>(key.get(), map.get_allocator()),
+                        dbus_deserialize_using_allocator<V>(value.get(), map.get_allocator()));
+        }
+    }
+
+private:
+    /* Succeeds only if every key of the message is found in the map and as many keys are found
+     * as the map holds. Keys of a D-Bus dictionary are unique, so every entry is then refilled. */
+    static bool refill(GVariant *message, Map &map)
+    {
         GVariantIter iterator;
         g_variant_iter_init(&iterator, message);
 
         GVariant *entry = nullptr;
+        K key = std::make_obj_using_allocator<K>(map.get_allocator());
+
+        size_t found_keys = 0;
 
         while ((entry = g_variant_iter_next_value(&iterator))) {
-            GVariant *key = g_variant_get_child_value(entry, 0);
-            GVariant *value = g_variant_get_child_value(entry, 1);
+            GVariantUniquePtr owned_entry(entry, &g_variant_unref);
+            GVariantUniquePtr key_entry(g_variant_get_child_value(entry, 0), &g_variant_unref);
+
+            dbus_deserialize_into(key_entry.get(), key);
+            auto found = map.find(key);
 
-            map.insert({
-                DBusDeserializer<K>::deserialize(key),
-                DBusDeserializer<V>::deserialize(value),
-            });
+            if (found == map.end()) {
+                return false;
+            }
 
-            g_variant_unref(entry);
-            g_variant_unref(key);
-            g_variant_unref(value);
+            ++found_keys;
+
+            GVariantUniquePtr value(g_variant_get_child_value(entry, 1), &g_variant_unref);
+            dbus_deserialize_into(value.get(), found->second);
         }
 
-        return map;
+        return found_keys == map.size();
+    }
+};
+
+template<typename K, typename V, typename Hash, typename Pred, typename Allocator>
+struct DBusDeserializer<std::unordered_map<K, V, Hash, Pred, Allocator>>
+    : DBusDictDeserializer<std::unordered_map<K, V, Hash, Pred, Allocator>, K, V>
+{};
+
+template<typename K, typename V, typename Compare, typename Allocator>
+struct DBusDeserializer<std::map<K, V, Compare, Allocator>>
+    : DBusDictDeserializer<std::map<K, V, Compare, Allocator>, K, V>
+{};
+
+template<typename K, typename V>
+struct DBusDeserializer<std::pair<K, V>>
+{
+    using Pair = std::pair<K, V>;
+
+    static Pair deserialize(GVariant *message)
+    {
+        if constexpr (is_dbus_fixed_layout_v<Pair>) {
+            if (g_variant_get_size(message) == dbus_layout_v<Pair>.fixed_size) {
+                return dbus_read_fixed_layout<Pair>(message);
+            }
+        }
+
+        const DBusDecodeDepth depth;
+
+        GVariantUniquePtr first(g_variant_get_child_value(message, 0), &g_variant_unref);
+        GVariantUniquePtr second(g_variant_get_child_value(message, 1), &g_variant_unref);
+
+        return {DBusDeserializer<K>::deserialize(first.get()),
+                DBusDeserializer<V>::deserialize(second.get())};
+    }
+
+    static void deserialize_into(GVariant *message, Pair &pair)
+    {
+        if constexpr (is_dbus_fixed_layout_v<Pair>) {
+            pair = deserialize(message);
+        } else {
+            const DBusDecodeDepth depth;
+
+            GVariantUniquePtr first(g_variant_get_child_value(message, 0), &g_variant_unref);
+            GVariantUniquePtr second(g_variant_get_child_value(message, 1), &g_variant_unref);
+
+            dbus_deserialize_into(first.get(), pair.first);
+            dbus_deserialize_into(second.get(), pair.second);
+        }
     }
 };
 
@@ -172,35 +491,216 @@ struct DBusDeserializer<std::tuple<T...>>
 
     static Tuple deserialize(GVariant *message)
     {
+        /* Structures of fixed-size members are read at once from the serialized data, the
+         * size check leaves values that are not in normal form to GLib */
+        if constexpr (is_dbus_fixed_layout_v<Tuple>) {
+            if (g_variant_get_size(message) == dbus_layout_v<Tuple>.fixed_size) {
+                return dbus_read_fixed_layout<Tuple>(message);
+            }
+        }
+
         return implementation(message, std::index_sequence_for<T...>());
     }
 
+    static void deserialize_into(GVariant *message, Tuple &tuple)
+    {
+        if constexpr (is_dbus_fixed_layout_v<Tuple>) {
+            tuple = deserialize(message);
+        } else {
+            implementation_into(message, tuple, std::index_sequence_for<T...>());
+        }
+    }
+
 private:
     template<size_t... I>
     static Tuple implementation(GVariant *message, std::index_sequence<I...>)
     {
-        using GVariantUniquePtr = std::unique_ptr<GVariant, decltype(&g_variant_unref)>;
+        const DBusDecodeDepth depth;
 
         return {DBusDeserializer<T>::deserialize(
             GVariantUniquePtr(g_variant_get_child_value(message, I), &g_variant_unref).get())...};
     }
+
+    template<size_t... I>
+    static void implementation_into(GVariant *message, Tuple &tuple, std::index_sequence<I...>)
+    {
+        const DBusDecodeDepth depth;
+
+        (dbus_deserialize_into(
+             GVariantUniquePtr(g_variant_get_child_value(message, I), &g_variant_unref).get(),
+             std::get<I>(tuple)),
+         ...);
+    }
+};
+
+/* The alternative of a std::variant is matched against the type of the value once, through
+ * a compile-time table indexed by the first character of the type. Alternatives of basic types
+ * need no further comparison, alternatives sharing the first character are compared in full. */
+template<typename... T>
+struct DBusDeserializer<std::variant<T...>>
+{
+    using Value = std::variant<T...>;
+
+    static_assert(sizeof...(T) > 0, "std::variant<> cannot be deserialized");
+
+    static Value deserialize(GVariant *message)
+    {
+        GVariantUniquePtr value(g_variant_get_variant(message), &g_variant_unref);
+        return deserialize_value(value.get());
+    }
+
+    static void deserialize_into(GVariant *message, Value &variant)
+    {
+        GVariantUniquePtr value(g_variant_get_variant(message), &g_variant_unref);
+        deserialize_value_into(value.get(), variant);
+    }
+
+    /* Decodes a value already unwrapped from the dbus variant */
+    static Value deserialize_value(GVariant *value)
+    {
+        const DBusDecodeDepth depth;
+        return decoders[alternative(value)](value);
+    }
+
+    /* The held alternative is refilled in place when the value has the same type */
+    static void deserialize_value_into(GVariant *value, Value &variant)
+    {
+        const DBusDecodeDepth depth;
+        refillers[alternative(value)](value, variant);
+    }
+
+private:
+    static constexpr size_t none = sizeof...(T);
+    static constexpr size_t several = sizeof...(T) + 1;
+
+    static constexpr std::array<std::string_view, sizeof...(T)> names = {
+        std::string_view(DBusType<T>::name.data())...};
+
+    static constexpr bool has_unique_names() noexcept
+    {
+        for (size_t i = 0; i < names.size(); ++i) {
+            for (size_t j = i + 1; j < names.size(); ++j) {
+                if (names[i] == names[j]) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    static_assert(has_unique_names(),
+                  "Alternatives of std::variant<T...> must have different dbus types");
+
+    static constexpr std::array<size_t, 256> table = [] {
+        std::array<size_t, 256> table = {};
+        table.fill(none);
+
+        for (size_t index = 0; index < names.size(); ++index) {
+            size_t &entry = table[static_cast<unsigned char>(names[index][0])];
+            entry = entry == none ? index : several;
+        }
+
+        return table;
+    }();
+
+    static size_t alternative(GVariant *value)
+    {
+        const char *type = g_variant_get_type_string(value);
+        const size_t index = table[static_cast<unsigned char>(type[0])];
+
+        /* Types of a single character are basic types, the first character is the whole type */
+        if (index < none && (names[index].size() == 1 || names[index] == type)) {
+            return index;
+        }
+
+        if (index == several) {
+            for (size_t candidate = 0; candidate < names.size(); ++candidate) {
+                if (names[candidate] == type) {
+                    return candidate;
+                }
+            }
+        }
+
+        GIO_DBUS_CPP_THROW_ERROR(std::string("Attempt to read a value of type ")
+                                 + DBusType<Value>::class_name.data()
+                                 + ", but the variant contains value of type " + type);
+    }
+
+    template<size_t I>
+    static Value decode(GVariant *value)
+    {
+        return Value(std::in_place_index<I>,
+                     DBusDeserializer<std::variant_alternative_t<I, Value>>::deserialize(value));
+    }
+
+    template<size_t I>
+    static void refill(GVariant *value, Value &variant)
+    {
+        if (variant.index() == I) {
+            dbus_deserialize_into(value, std::get<I>(variant));
+        } else {
+            variant.template emplace<I>(
+                DBusDeserializer<std::variant_alternative_t<I, Value>>::deserialize(value));
+        }
+    }
+
+    static constexpr auto decoders = []<size_t... I>(std::index_sequence<I...>) {
+        return std::array<Value (*)(GVariant *), sizeof...(T)>{&decode<I>...};
+    }(std::index_sequence_for<T...>());
+
+    static constexpr auto refillers = []<size_t... I>(std::index_sequence<I...>) {
+        return std::array<void (*)(GVariant *, Value &), sizeof...(T)>{&refill<I>...};
+    }(std::index_sequence_for<T...>());
 };
 
 template<>
 struct DBusDeserializer<ObjectPath>
 {
-    static ObjectPath deserialize(GVariant *message) noexcept
+    static ObjectPath deserialize(GVariant *message)
     {
-        return {g_variant_get_string(message, nullptr)};
+        gsize length = 0;
+        const char *object_path = g_variant_get_string(message, &length);
+        dbus_decode_bytes(length);
+
+        return ObjectPath(SmallString(std::string_view(object_path, length)));
+    }
+};
+
+template<>
+struct DBusDeserializer<ObjectPathView>
+{
+    static ObjectPathView deserialize(GVariant *message) noexcept
+    {
+        gsize length = 0;
+        const char *object_path = g_variant_get_string(message, &length);
+
+        return {std::string_view(object_path, length)};
     }
 };
 
 template<>
 struct DBusDeserializer<Signature>
 {
-    static Signature deserialize(GVariant *message) noexcept
+    static Signature deserialize(GVariant *message)
+    {
+        gsize length = 0;
+        const char *signature = g_variant_get_string(message, &length);
+        dbus_decode_bytes(length);
+
+        return Signature(SmallString(std::string_view(signature, length)));
+    }
+};
+
+template<>
+struct DBusDeserializer<SignatureView>
+{
+    static SignatureView deserialize(GVariant *message) noexcept
     {
-        return {g_variant_get_string(message, nullptr)};
+        gsize length = 0;
+        const char *signature = g_variant_get_string(message, &length);
+
+        return {std::string_view(signature, length)};
     }
 };
 
@@ -213,6 +713,49 @@ struct DBusDeserializer<UnixFD>
     }
 };
 
+template<DBusStructType T>
+struct DBusDeserializer<T>
+{
+    static_assert(std::is_default_constructible_v<T>,
+                  "Only default constructible structures can be deserialized, the members are "
+                  "assigned one by one");
+
+    static T deserialize(GVariant *message)
+    {
+        if constexpr (is_dbus_fixed_layout_v<T>) {
+            if (g_variant_get_size(message) == dbus_layout_v<T>.fixed_size) {
+                return dbus_read_fixed_layout<T>(message);
+            }
+        }
+
+        T value{};
+        implementation(message, value, std::make_index_sequence<dbus_struct_size_v<T>>());
+
+        return value;
+    }
+
+    static void deserialize_into(GVariant *message, T &value)
+    {
+        if constexpr (is_dbus_fixed_layout_v<T>) {
+            value = deserialize(message);
+        } else {
+            implementation(message, value, std::make_index_sequence<dbus_struct_size_v<T>>());
+        }
+    }
+
+private:
+    template<size_t... I>
+    static void implementation(GVariant *message, T &value, std::index_sequence<I...>)
+    {
+        const DBusDecodeDepth depth;
+
+        (dbus_deserialize_into(
+             GVariantUniquePtr(g_variant_get_child_value(message, I), &g_variant_unref).get(),
+             value.*dbus_struct_member_v<T, I>),
+         ...);
+    }
+};
+
 } /* namespace Gio::DBus::Details */
 
 #endif /* GIO_DBUS_CPP_DETAILS_DBUS_TYPE_DESERIALIZER_HPP */
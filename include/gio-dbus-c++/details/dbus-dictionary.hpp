@@ -0,0 +1,221 @@
+#ifndef GIO_DBUS_CPP_DETAILS_DBUS_DICTIONARY_HPP
+#define GIO_DBUS_CPP_DETAILS_DBUS_DICTIONARY_HPP
+
+#include "dbus-deserializer.hpp"
+#include "dbus-layout.hpp"
+#include "dbus-type-traits.hpp"
+#include "exception.hpp"
+
+#include <array>
+#include <cstring>
+#include <gio/gio.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace Gio::DBus {
+
+class Variant;
+
+} /* namespace Gio::DBus */
+
+namespace Gio::DBus::Details {
+
+template<typename T>
+using DBusDictionaryKey = std::string_view;
+
+/* Walks the entries of a serialized dictionary with string keys (a{sX}, a{oX} or a{gX})
+ * and calls on_entry(key, value_data, value_size) until it returns false. The layout is the
+ * layout of X. Returns false if the data is not in normal form, such data is left to GLib. */
+template<typename OnEntry>
+bool dbus_scan_dictionary(const char *data, size_t size, DBusLayout value, const OnEntry &on_entry)
+{
+    if (!size) {
+        return true;
+    }
+
+    const size_t offset_size = dbus_offset_size(size);
+    const size_t offsets = dbus_read_offset(data + size - offset_size, offset_size);
+
+    if (offsets > size || (size - offsets) % offset_size) {
+        return false;
+    }
+
+    size_t start = 0;
+
+    for (size_t offset = offsets; offset < size; offset += offset_size) {
+        const size_t end = dbus_read_offset(data + offset, offset_size);
+        start = dbus_align(start, value.alignment);
+
+        if (start > end || end > offsets) {
+            return false;
+        }
+
+        /* Every entry is the nul-terminated key, the aligned value and the end of the key */
+        const char *entry = data + start;
+        const size_t entry_size = end - start;
+        const size_t entry_offset_size = dbus_offset_size(entry_size);
+
+        if (entry_size <= entry_offset_size) {
+            return false;
+        }
+
+        const size_t body_size = entry_size - entry_offset_size;
+        const size_t key_end = dbus_read_offset(entry + body_size, entry_offset_size);
+
+        if (!key_end || key_end > body_size || entry[key_end - 1] != '\0') {
+            return false;
+        }
+
+        const size_t value_start = dbus_align(key_end, value.alignment);
+        const size_t value_end = value.fixed_size ? value_start + value.fixed_size : body_size;
+
+        if (value_start > value_end || value_end > body_size) {
+            return false;
+        }
+
+        if (!on_entry(std::string_view(entry, key_end - 1), entry + value_start,
+                      value_end - value_start)) {
+            return true;
+        }
+
+        start = end;
+    }
+
+    return true;
+}
+
+/* Values of a{sv} are unwrapped when the requested type is not a variant type itself,
+ * Gio::DBus::Variant or std::variant */
+template<typename V>
+V dbus_dictionary_value(GVariant *value)
+{
+    if constexpr (std::string_view(DBusType<V>::name.data()) != "v") {
+        if (g_variant_is_of_type(value, G_VARIANT_TYPE_VARIANT)) {
+            GVariantUniquePtr child(g_variant_get_variant(value), &g_variant_unref);
+
+            if (!g_variant_is_of_type(child.get(), dbus_type_to_variant_type_v<V>)) {
+                GIO_DBUS_CPP_THROW_ERROR(std::string("Attempt to look up a value of type V (aka ")
+                                         + DBusType<V>::class_name.data() + " aka "
+                                         + DBusType<V>::name.data()
+                                         + "), but the dictionary contains value of type "
+                                         + g_variant_get_type_string(child.get()));
+            }
+
+            return DBusDeserializer<V>::deserialize(child.get());
+        }
+    }
+
+    return DBusDeserializer<V>::deserialize(value);
+}
+
+template<typename V>
+void dbus_dictionary_check(GVariant *dictionary, std::string_view value_type)
+{
+    const bool is_variant = !std::is_same_v<V, Gio::DBus::Variant> && value_type == "v";
+
+    if (!is_variant && value_type != DBusType<V>::name.data()) {
+        GIO_DBUS_CPP_THROW_ERROR(std::string("Attempt to look up a value of type V (aka ")
+                                 + DBusType<V>::class_name.data() + " aka "
+                                 + DBusType<V>::name.data() + ") in a dictionary of type "
+                                 + g_variant_get_type_string(dictionary));
+    }
+}
+
+/* Looks up the keys in a dictionary with string keys, decoding only the values of the keys
+ * found. Serialized dictionaries are scanned in place without creating a GVariant per entry,
+ * the first entry wins if a key is repeated. */
+template<typename... V>
+std::tuple<std::optional<V>...> dbus_dictionary_lookup(
+    GVariant *dictionary, const std::array<std::string_view, sizeof...(V)> &keys)
+{
+    static_assert((is_dbus_type_v<V> && ...),
+                  "Attempt to look up a value of type V in a dictionary, but V is not a dbus type");
+
+    static_assert((!is_dbus_view_type_v<V> && ...),
+                  "Attempt to look up a value of type V in a dictionary, but V borrows from the "
+                  "dictionary");
+
+    const char *type = g_variant_get_type_string(dictionary);
+
+    if (type[0] != 'a' || type[1] != '{' || !std::strchr("sog", type[2])) {
+        GIO_DBUS_CPP_THROW_ERROR(std::string("Attempt to look up a value in a dictionary, but ")
+                                 + "the value of type " + type
+                                 + " is not a dictionary with string keys");
+    }
+
+    const std::string_view value_type(type + 3, std::strlen(type) - 4);
+    (dbus_dictionary_check<V>(dictionary, value_type), ...);
+
+    std::tuple<std::optional<V>...> values;
+    std::array<bool, sizeof...(V)> found = {};
+    size_t remaining = sizeof...(V);
+
+    const auto assign = [&values]<size_t... I>(size_t index, GVariant *value,
+                                                 std::index_sequence<I...>) {
+        ((I == index ? (void)(std::get<I>(values) = dbus_dictionary_value<V>(value)) : void()),
+         ...);
+    };
+
+    /* make_value creates the GVariant of the value only when the key matches */
+    const auto on_entry = [&](std::string_view key, const auto &make_value) {
+        for (size_t index = 0; index < sizeof...(V); ++index) {
+            if (!found[index] && keys[index] == key) {
+                GVariantUniquePtr value(make_value(), &g_variant_unref);
+                assign(index, value.get(), std::index_sequence_for<V...>());
+
+                found[index] = true;
+                --remaining;
+            }
+        }
+
+        return remaining != 0;
+    };
+
+    const GVariantType *value_variant_type = g_variant_type_value(
+        g_variant_type_element(g_variant_get_type(dictionary)));
+
+    const bool is_normal_form = dbus_scan_dictionary(
+        static_cast<const char *>(g_variant_get_data(dictionary)), g_variant_get_size(dictionary),
+        dbus_signature_layout(value_type.data()),
+        [&](std::string_view key, const char *data, size_t size) {
+            return on_entry(key, [&] {
+                return g_variant_ref_sink(g_variant_new_from_data(
+                    value_variant_type, data, size, false,
+                    reinterpret_cast<GDestroyNotify>(&g_variant_unref), g_variant_ref(dictionary)));
+            });
+        });
+
+    if (is_normal_form) {
+        return values;
+    }
+
+    values = {};
+    found = {};
+    remaining = sizeof...(V);
+
+    GVariantIter iterator;
+    g_variant_iter_init(&iterator, dictionary);
+
+    GVariant *entry = nullptr;
+
+    while (remaining && (entry = g_variant_iter_next_value(&iterator))) {
+        GVariantUniquePtr owned_entry(entry, &g_variant_unref);
+        GVariantUniquePtr key(g_variant_get_child_value(entry, 0), &g_variant_unref);
+
+        gsize length = 0;
+        const char *string = g_variant_get_string(key.get(), &length);
+
+        on_entry(std::string_view(string, length), [entry] {
+            return g_variant_get_child_value(entry, 1);
+        });
+    }
+
+    return values;
+}
+
+} /* namespace Gio::DBus::Details */
+
+#endif /* GIO_DBUS_CPP_DETAILS_DBUS_DICTIONARY_HPP */
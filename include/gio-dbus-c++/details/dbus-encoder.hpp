@@ -0,0 +1,482 @@
+#ifndef GIO_DBUS_CPP_DETAILS_DBUS_ENCODER_HPP
+#define GIO_DBUS_CPP_DETAILS_DBUS_ENCODER_HPP
+
+#include "dbus-layout.hpp"
+#include "dbus-type-traits.hpp"
+#include "exception.hpp"
+
+#include "../object-path.hpp"
+#include "../signature.hpp"
+#include "../unix-fd.hpp"
+
+#include <array>
+#include <cstring>
+#include <deque>
+#include <gio/gio.h>
+#include <iterator>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace Gio::DBus::Details {
+
+/* Writes values straight in the GVariant serialized form. Every specialization provides
+ * size(value), the exact number of bytes of the serialized value, and encode(value, data),
+ * which writes these bytes at data and returns their number. The data is aligned at least
+ * to the alignment of the type, the positions inside a value are relative to its start. */
+template<typename T>
+struct DBusEncoder
+{};
+
+template<typename T>
+    requires(is_dbus_type_v<T> && std::is_arithmetic_v<T>)
+struct DBusEncoder<T>
+{
+    static size_t size(T) noexcept
+    {
+        return sizeof(T);
+    }
+
+    static size_t encode(T value, char *data) noexcept
+    {
+        if constexpr (std::is_same_v<T, bool>) {
+            *data = value ? 1 : 0;
+        } else {
+            std::memcpy(data, &value, sizeof(T));
+        }
+
+        return sizeof(T);
+    }
+};
+
+template<bool ValidateUtf8>
+struct DBusStringEncoder
+{
+    static size_t size(std::string_view string)
+    {
+        if constexpr (ValidateUtf8) {
+            if (!g_utf8_validate_len(string.data(), string.size(), nullptr)) {
+                GIO_DBUS_CPP_THROW_ERROR("Attempt to encode a string that is not valid UTF-8 "
+                                         "or contains a nul character");
+            }
+        }
+
+        return string.size() + 1;
+    }
+
+    static size_t encode(std::string_view string, char *data) noexcept
+    {
+        std::memcpy(data, string.data(), string.size());
+        data[string.size()] = '\0';
+
+        return string.size() + 1;
+    }
+};
+
+template<typename Allocator>
+struct DBusEncoder<std::basic_string<char, std::char_traits<char>, Allocator>>
+    : DBusStringEncoder<true>
+{};
+
+template<>
+struct DBusEncoder<std::string_view>: DBusStringEncoder<true>
+{};
+
+template<>
+struct DBusEncoder<ObjectPath>
+{
+    static size_t size(const ObjectPath &object_path) noexcept
+    {
+        return DBusStringEncoder<false>::size(object_path.as_string_view());
+    }
+
+    static size_t encode(const ObjectPath &object_path, char *data) noexcept
+    {
+        return DBusStringEncoder<false>::encode(object_path.as_string_view(), data);
+    }
+};
+
+template<>
+struct DBusEncoder<ObjectPathView>
+{
+    static size_t size(const ObjectPathView &object_path) noexcept
+    {
+        return DBusStringEncoder<false>::size(object_path.as_string_view());
+    }
+
+    static size_t encode(const ObjectPathView &object_path, char *data) noexcept
+    {
+        return DBusStringEncoder<false>::encode(object_path.as_string_view(), data);
+    }
+};
+
+template<>
+struct DBusEncoder<Signature>
+{
+    static size_t size(const Signature &signature) noexcept
+    {
+        return DBusStringEncoder<false>::size(signature.as_string_view());
+    }
+
+    static size_t encode(const Signature &signature, char *data) noexcept
+    {
+        return DBusStringEncoder<false>::encode(signature.as_string_view(), data);
+    }
+};
+
+template<>
+struct DBusEncoder<SignatureView>
+{
+    static size_t size(const SignatureView &signature) noexcept
+    {
+        return DBusStringEncoder<false>::size(signature.as_string_view());
+    }
+
+    static size_t encode(const SignatureView &signature, char *data) noexcept
+    {
+        return DBusStringEncoder<false>::encode(signature.as_string_view(), data);
+    }
+};
+
+template<>
+struct DBusEncoder<UnixFD>
+{
+    static size_t size(const UnixFD &) noexcept
+    {
+        return sizeof(int32_t);
+    }
+
+    static size_t encode(const UnixFD &unix_fd, char *data) noexcept
+    {
+        return DBusEncoder<int32_t>::encode(unix_fd.as_int(), data);
+    }
+};
+
+/* Structures and dict entries: members are aligned one after another, the end of every
+ * variable-size member except the last is stored in the framing offsets at the end of the
+ * structure in reverse order, structures of fixed-size members are padded to their size. */
+template<typename... T>
+struct DBusStructEncoder
+{
+    static constexpr DBusLayout layout = dbus_struct_layout<T...>();
+
+    static size_t size(const T &...members)
+    {
+        if constexpr (layout.fixed_size) {
+            return layout.fixed_size;
+        } else {
+            size_t position = 0;
+
+            ((position = dbus_align(position, dbus_layout_v<T>.alignment)
+                         + DBusEncoder<T>::size(members)),
+             ...);
+
+            return dbus_container_size(position, framing_offsets);
+        }
+    }
+
+    static size_t encode(char *data, const T &...members)
+    {
+        return implementation(data, std::index_sequence_for<T...>(), members...);
+    }
+
+private:
+    static constexpr size_t framing_offsets = dbus_struct_framing_offsets<T...>();
+
+    template<size_t... I>
+    static size_t implementation(char *data,
+                                 std::index_sequence<I...>,
+                                 const T &...members)
+    {
+        std::array<size_t, framing_offsets> ends = {};
+        size_t end = 0;
+        size_t position = 0;
+
+        const auto encode_member = [&]<typename M>(const M &member, size_t index) {
+            position = dbus_pad(data, position, dbus_layout_v<M>.alignment);
+            position += DBusEncoder<M>::encode(member, data + position);
+
+            if (!dbus_layout_v<M>.fixed_size && index + 1 < sizeof...(T)) {
+                ends[end++] = position;
+            }
+        };
+
+        (encode_member(members, I), ...);
+
+        if constexpr (layout.fixed_size) {
+            std::memset(data + position, 0, layout.fixed_size - position);
+            return layout.fixed_size;
+        } else {
+            const size_t total = dbus_container_size(position, framing_offsets);
+            const size_t offset_size = dbus_offset_size(total);
+
+            for (size_t i = 0; i < framing_offsets; ++i) {
+                dbus_write_offset(data + total - (i + 1) * offset_size, ends[i], offset_size);
+            }
+
+            return total;
+        }
+    }
+};
+
+template<typename T>
+struct DBusElementEncoder: DBusEncoder<T>
+{
+    static constexpr DBusLayout layout = dbus_layout_v<T>;
+};
+
+template<typename K, typename V>
+struct DBusDictEntryEncoder
+{
+    static constexpr DBusLayout layout = DBusStructEncoder<K, V>::layout;
+
+    template<typename Entry>
+    static size_t size(const Entry &entry)
+    {
+        return DBusStructEncoder<K, V>::size(entry.first, entry.second);
+    }
+
+    template<typename Entry>
+    static size_t encode(const Entry &entry, char *data)
+    {
+        return DBusStructEncoder<K, V>::encode(data, entry.first, entry.second);
+    }
+};
+
+/* Arrays: fixed-size elements are simply concatenated, variable-size elements are aligned
+ * one after another and followed by the framing offsets of their ends. */
+template<typename Range, typename Element>
+struct DBusArrayEncoder
+{
+    static size_t size(const Range &range)
+    {
+        if constexpr (Element::layout.fixed_size) {
+            return std::size(range) * Element::layout.fixed_size;
+        } else {
+            size_t position = 0;
+
+            for (const auto &element: range) {
+                position = dbus_align(position, Element::layout.alignment)
+                           + Element::size(element);
+            }
+
+            return dbus_container_size(position, std::size(range));
+        }
+    }
+
+    static size_t encode(const Range &range, char *data)
+    {
+        size_t position = 0;
+
+        if constexpr (Element::layout.fixed_size) {
+            using Value = std::remove_cvref_t<decltype(*std::begin(range))>;
+
+            if constexpr (is_dbus_trivial_type_v<Value> && std::contiguous_iterator<
+                                                              decltype(std::begin(range))>) {
+                position = std::size(range) * sizeof(Value);
+                std::memcpy(data, std::data(range), position);
+            } else {
+                for (const auto &element: range) {
+                    position += Element::encode(element, data + position);
+                }
+            }
+
+            return position;
+        } else {
+            /* The ends are kept until the body is written, its size gives the size of the
+             * offsets without computing the size of the elements again at every nesting level */
+            const size_t count = std::size(range);
+            std::array<size_t, inline_ends> inline_storage;
+            std::vector<size_t> heap_storage;
+            size_t *ends = inline_storage.data();
+
+            if (count > inline_ends) {
+                heap_storage.resize(count);
+                ends = heap_storage.data();
+            }
+
+            size_t *end = ends;
+
+            for (const auto &element: range) {
+                position = dbus_pad(data, position, Element::layout.alignment);
+                position += Element::encode(element, data + position);
+                *end++ = position;
+            }
+
+            const size_t total = dbus_container_size(position, count);
+            const size_t offset_size = dbus_offset_size(total);
+
+            for (size_t i = 0; i < count; ++i) {
+                dbus_write_offset(data + position + i * offset_size, ends[i], offset_size);
+            }
+
+            return total;
+        }
+    }
+
+private:
+    static constexpr size_t inline_ends = 32;
+};
+
+template<typename T, typename Allocator>
+struct DBusEncoder<std::vector<T, Allocator>>
+    : DBusArrayEncoder<std::vector<T, Allocator>, DBusElementEncoder<T>>
+{};
+
+template<typename T, size_t N>
+struct DBusEncoder<std::array<T, N>>: DBusArrayEncoder<std::array<T, N>, DBusElementEncoder<T>>
+{};
+
+template<typename T, size_t Extent>
+struct DBusEncoder<std::span<T, Extent>>
+    : DBusArrayEncoder<std::span<T, Extent>, DBusElementEncoder<std::remove_const_t<T>>>
+{};
+
+template<typename T, typename Allocator>
+struct DBusEncoder<std::deque<T, Allocator>>
+    : DBusArrayEncoder<std::deque<T, Allocator>, DBusElementEncoder<T>>
+{};
+
+template<typename K, typename V, typename Hash, typename Pred, typename Allocator>
+struct DBusEncoder<std::unordered_map<K, V, Hash, Pred, Allocator>>
+    : DBusArrayEncoder<std::unordered_map<K, V, Hash, Pred, Allocator>, DBusDictEntryEncoder<K, V>>
+{};
+
+template<typename K, typename V, typename Compare, typename Allocator>
+struct DBusEncoder<std::map<K, V, Compare, Allocator>>
+    : DBusArrayEncoder<std::map<K, V, Compare, Allocator>, DBusDictEntryEncoder<K, V>>
+{};
+
+template<typename K, typename V>
+struct DBusEncoder<std::pair<K, V>>
+{
+    static size_t size(const std::pair<K, V> &pair)
+    {
+        return DBusStructEncoder<K, V>::size(pair.first, pair.second);
+    }
+
+    static size_t encode(const std::pair<K, V> &pair, char *data)
+    {
+        return DBusStructEncoder<K, V>::encode(data, pair.first, pair.second);
+    }
+};
+
+/* Members of tuples of references are encoded straight from the referenced values */
+template<typename... T>
+struct DBusEncoder<std::tuple<T...>>
+{
+    using Tuple = std::tuple<T...>;
+    using Encoder = DBusStructEncoder<std::remove_cvref_t<T>...>;
+
+    static size_t size(const Tuple &tuple)
+    {
+        return std::apply(Encoder::size, tuple);
+    }
+
+    static size_t encode(const Tuple &tuple, char *data)
+    {
+        return std::apply(
+            [data](const std::remove_cvref_t<T> &...members) {
+                return Encoder::encode(data, members...);
+            },
+            tuple);
+    }
+};
+
+/* The serialized variant is the serialized alternative followed by a nul byte and its type */
+template<typename... T>
+struct DBusEncoder<std::variant<T...>>
+{
+    using Value = std::variant<T...>;
+
+    static size_t size(const Value &variant)
+    {
+        return std::visit(
+            []<typename A>(const A &value) {
+                return DBusEncoder<A>::size(value) + 1 + type_size<A>();
+            },
+            variant);
+    }
+
+    static size_t encode(const Value &variant, char *data)
+    {
+        return std::visit(
+            [data]<typename A>(const A &value) {
+                const size_t size = DBusEncoder<A>::encode(value, data);
+
+                data[size] = '\0';
+                std::memcpy(data + size + 1, DBusType<A>::name.data(), type_size<A>());
+
+                return size + 1 + type_size<A>();
+            },
+            variant);
+    }
+
+private:
+    template<typename A>
+    static constexpr size_t type_size() noexcept
+    {
+        return std::char_traits<char>::length(DBusType<A>::name.data());
+    }
+};
+
+template<DBusStructType T>
+struct DBusEncoder<T>
+{
+    using Members = decltype(dbus_struct_tie(std::declval<const T &>()));
+
+    static size_t size(const T &value)
+    {
+        return DBusEncoder<Members>::size(dbus_struct_tie(value));
+    }
+
+    static size_t encode(const T &value, char *data)
+    {
+        return DBusEncoder<Members>::encode(dbus_struct_tie(value), data);
+    }
+};
+
+/* Allocates a single buffer of the exact size, fills it with the encode function and wraps
+ * it into a trusted GVariant without building a tree of intermediate GVariant instances */
+template<typename T, typename Encode>
+GVariant *dbus_encode_buffer(size_t size, const Encode &encode)
+{
+    char *data = static_cast<char *>(g_malloc(size));
+    encode(data);
+
+    GBytes *bytes = g_bytes_new_take(data, size);
+    GVariant *variant = g_variant_new_from_bytes(dbus_type_to_variant_type_v<T>, bytes, true);
+    g_bytes_unref(bytes);
+
+    return variant;
+}
+
+template<typename T>
+GVariant *dbus_encode(const T &value)
+{
+    return dbus_encode_buffer<T>(DBusEncoder<T>::size(value), [&value](char *data) {
+        DBusEncoder<T>::encode(value, data);
+    });
+}
+
+/* Encodes the values as members of a structure without copying them into a tuple first */
+template<typename... T>
+GVariant *dbus_encode_struct(const T &...members)
+{
+    return dbus_encode_buffer<std::tuple<T...>>(DBusStructEncoder<T...>::size(members...),
+                                                [&members...](char *data) {
+                                                    DBusStructEncoder<T...>::encode(data,
+                                                                                    members...);
+                                                });
+}
+
+} /* namespace Gio::DBus::Details */
+
+#endif /* GIO_DBUS_CPP_DETAILS_DBUS_ENCODER_HPP */
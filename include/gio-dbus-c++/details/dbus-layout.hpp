@@ -0,0 +1,339 @@
+#ifndef GIO_DBUS_CPP_DETAILS_DBUS_LAYOUT_HPP
+#define GIO_DBUS_CPP_DETAILS_DBUS_LAYOUT_HPP
+
+#include "dbus-type-traits.hpp"
+
+#include "../unix-fd.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Gio::DBus::Details {
+
+/* Alignment and size of a type in the GVariant serialized form,
+ * fixed_size is 0 for types whose size depends on the value. */
+struct DBusLayout
+{
+    size_t alignment;
+    size_t fixed_size;
+};
+
+constexpr size_t dbus_align(size_t offset, size_t alignment) noexcept
+{
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+/* Computes the layout of the first complete type of the signature. Containers are tracked
+ * with an explicit stack, GVariant limits the nesting depth of types to 128 levels. */
+constexpr DBusLayout dbus_signature_layout(const char *signature) noexcept
+{
+    struct Frame
+    {
+        bool is_array;
+        size_t alignment;
+        size_t size;
+        bool is_fixed_size;
+    };
+
+    Frame frames[128] = {};
+    size_t depth = 0;
+
+    for (const char *type = signature; *type; ++type) {
+        DBusLayout layout = {1, 0};
+
+        switch (*type) {
+        case 'a':
+        case '(':
+        case '{':
+            if (depth == std::size(frames)) {
+                return {1, 0};
+            }
+
+            frames[depth++] = {*type == 'a', 1, 0, true};
+            continue;
+        case ')':
+        case '}': {
+            const Frame &frame = frames[--depth];
+
+            if (frame.is_fixed_size) {
+                const size_t size = dbus_align(frame.size, frame.alignment);
+                layout = {frame.alignment, size ? size : 1};
+            } else {
+                layout = {frame.alignment, 0};
+            }
+            break;
+        }
+        case 'b':
+        case 'y':
+            layout = {1, 1};
+            break;
+        case 'n':
+        case 'q':
+            layout = {2, 2};
+            break;
+        case 'i':
+        case 'u':
+        case 'h':
+            layout = {4, 4};
+            break;
+        case 'x':
+        case 't':
+        case 'd':
+            layout = {8, 8};
+            break;
+        case 'v':
+            layout = {8, 0};
+            break;
+        default:
+            layout = {1, 0};
+            break;
+        }
+
+        while (depth && frames[depth - 1].is_array) {
+            layout.fixed_size = 0;
+            --depth;
+        }
+
+        if (!depth) {
+            return layout;
+        }
+
+        Frame &frame = frames[depth - 1];
+        frame.alignment = std::max(frame.alignment, layout.alignment);
+
+        if (frame.is_fixed_size && layout.fixed_size) {
+            frame.size = dbus_align(frame.size, layout.alignment) + layout.fixed_size;
+        } else {
+            frame.is_fixed_size = false;
+        }
+    }
+
+    return {1, 0};
+}
+
+template<typename T>
+constexpr DBusLayout dbus_layout_v = dbus_signature_layout(DBusType<T>::name.data());
+
+/* Offsets of the members of a structure, valid up to its first variable-size member */
+template<typename... T>
+constexpr std::array<size_t, sizeof...(T)> dbus_struct_offsets() noexcept
+{
+    constexpr DBusLayout layouts[] = {dbus_layout_v<T>...};
+
+    std::array<size_t, sizeof...(T)> offsets = {};
+    size_t offset = 0;
+
+    for (size_t i = 0; i < sizeof...(T); ++i) {
+        offset = dbus_align(offset, layouts[i].alignment);
+        offsets[i] = offset;
+        offset += layouts[i].fixed_size;
+    }
+
+    return offsets;
+}
+
+/* Layout of a structure made of the given members, the same as of "(T...)" */
+template<typename... T>
+constexpr DBusLayout dbus_struct_layout() noexcept
+{
+    constexpr DBusLayout layouts[] = {dbus_layout_v<T>...};
+
+    size_t alignment = 1;
+    size_t offset = 0;
+    bool is_fixed_size = true;
+
+    for (const DBusLayout &layout: layouts) {
+        alignment = std::max(alignment, layout.alignment);
+        offset = dbus_align(offset, layout.alignment) + layout.fixed_size;
+        is_fixed_size = is_fixed_size && layout.fixed_size;
+    }
+
+    if (!is_fixed_size) {
+        return {alignment, 0};
+    }
+
+    offset = dbus_align(offset, alignment);
+    return {alignment, offset ? offset : 1};
+}
+
+/* Number of framing offsets of a structure, one per variable-size member except the last */
+template<typename... T>
+constexpr size_t dbus_struct_framing_offsets() noexcept
+{
+    constexpr DBusLayout layouts[] = {dbus_layout_v<T>...};
+
+    size_t count = 0;
+
+    for (size_t i = 0; i + 1 < sizeof...(T); ++i) {
+        count += layouts[i].fixed_size == 0;
+    }
+
+    return count;
+}
+
+/* Size of the framing offsets used by a container of the given total size */
+constexpr size_t dbus_offset_size(size_t size) noexcept
+{
+    if (size > std::numeric_limits<uint32_t>::max()) {
+        return 8;
+    }
+
+    if (size > std::numeric_limits<uint16_t>::max()) {
+        return 4;
+    }
+
+    if (size > std::numeric_limits<uint8_t>::max()) {
+        return 2;
+    }
+
+    return size ? 1 : 0;
+}
+
+/* Total size of a container with the given body and number of framing offsets, the offset
+ * size is the smallest one able to address the whole container */
+constexpr size_t dbus_container_size(size_t body_size, size_t offsets) noexcept
+{
+    if (body_size + offsets <= std::numeric_limits<uint8_t>::max()) {
+        return body_size + offsets;
+    }
+
+    if (body_size + 2 * offsets <= std::numeric_limits<uint16_t>::max()) {
+        return body_size + 2 * offsets;
+    }
+
+    if (body_size + 4 * offsets <= std::numeric_limits<uint32_t>::max()) {
+        return body_size + 4 * offsets;
+    }
+
+    return body_size + 8 * offsets;
+}
+
+inline void dbus_write_offset(char *data, size_t offset, size_t offset_size) noexcept
+{
+    for (size_t i = 0; i < offset_size; ++i) {
+        data[i] = static_cast<char>((offset >> (8 * i)) & 0xff);
+    }
+}
+
+inline size_t dbus_read_offset(const char *data, size_t offset_size) noexcept
+{
+    size_t offset = 0;
+
+    for (size_t i = 0; i < offset_size; ++i) {
+        offset |= static_cast<size_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+
+    return offset;
+}
+
+/* Zero-fills the padding needed to align the position and returns the aligned position */
+inline size_t dbus_pad(char *data, size_t position, size_t alignment) noexcept
+{
+    const size_t aligned = dbus_align(position, alignment);
+    std::memset(data + position, 0, aligned - position);
+
+    return aligned;
+}
+
+/* Fixed-size types that can be read straight from the GVariant serialized form without
+ * creating a child GVariant, the data must be exactly dbus_layout_v<T>.fixed_size bytes. */
+template<typename T>
+struct DBusFixedLayout: std::false_type
+{};
+
+template<typename T>
+    requires(is_dbus_type_v<T> && std::is_arithmetic_v<T>)
+struct DBusFixedLayout<T>: std::true_type
+{
+    static T read(const char *data) noexcept
+    {
+        if constexpr (std::is_same_v<T, bool>) {
+            return *data != 0;
+        } else {
+            T value;
+            std::memcpy(&value, data, sizeof(T));
+
+            return value;
+        }
+    }
+};
+
+template<>
+struct DBusFixedLayout<UnixFD>: std::true_type
+{
+    static UnixFD read(const char *data) noexcept
+    {
+        return DBusFixedLayout<int32_t>::read(data);
+    }
+};
+
+template<typename... T>
+    requires(DBusFixedLayout<T>::value && ...)
+struct DBusFixedLayout<std::tuple<T...>>: std::true_type
+{
+    using Tuple = std::tuple<T...>;
+
+    static constexpr std::array<size_t, sizeof...(T)> offsets = dbus_struct_offsets<T...>();
+
+    static Tuple read(const char *data) noexcept
+    {
+        return implementation(data, std::index_sequence_for<T...>());
+    }
+
+private:
+    template<size_t... I>
+    static Tuple implementation(const char *data, std::index_sequence<I...>) noexcept
+    {
+        return {DBusFixedLayout<T>::read(data + offsets[I])...};
+    }
+};
+
+template<typename K, typename V>
+    requires(DBusFixedLayout<K>::value && DBusFixedLayout<V>::value)
+struct DBusFixedLayout<std::pair<K, V>>: std::true_type
+{
+    static std::pair<K, V> read(const char *data) noexcept
+    {
+        auto [first, second] = DBusFixedLayout<std::tuple<K, V>>::read(data);
+        return {first, second};
+    }
+};
+
+template<DBusStructType T>
+    requires(DBusFixedLayout<dbus_struct_tuple_t<T>>::value)
+struct DBusFixedLayout<T>: std::true_type
+{
+    static T read(const char *data) noexcept
+    {
+        T value{};
+        implementation(data, value, std::make_index_sequence<dbus_struct_size_v<T>>());
+
+        return value;
+    }
+
+private:
+    template<size_t... I>
+    static void implementation(const char *data, T &value, std::index_sequence<I...>) noexcept
+    {
+        using Members = dbus_struct_tuple_t<T>;
+        constexpr auto offsets = DBusFixedLayout<Members>::offsets;
+
+        ((value.*dbus_struct_member_v<T, I> =
+              DBusFixedLayout<std::tuple_element_t<I, Members>>::read(data + offsets[I])),
+         ...);
+    }
+};
+
+template<typename T>
+constexpr bool is_dbus_fixed_layout_v = DBusFixedLayout<std::decay_t<T>>::value;
+
+} /* namespace Gio::DBus::Details */
+
+#endif /* GIO_DBUS_CPP_DETAILS_DBUS_LAYOUT_HPP */
@@ -2,15 +2,25 @@
 #define GIO_DBUS_CPP_DETAILS_DBUS_TYPE_SERIALIZER_HPP
 
 #include "dbus-type-traits.hpp"
+#include "exception.hpp"
 
 #include "../object-path.hpp"
 #include "../signature.hpp"
 #include "../unix-fd.hpp"
 
+#include <array>
+#include <deque>
 #include <gio/gio.h>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <unordered_map>
+#include <utility>
+#include <variant>
 #include <vector>
 
 namespace Gio::DBus::Details {
@@ -100,38 +110,85 @@ struct DBusSerializer<double>
     }
 };
 
-template<>
-struct DBusSerializer<std::string>
+template<typename Allocator>
+struct DBusSerializer<std::basic_string<char, std::char_traits<char>, Allocator>>
 {
-    static GVariant *serialize(const std::string &string) noexcept
+    using String = std::basic_string<char, std::char_traits<char>, Allocator>;
+
+    static GVariant *serialize(const String &string) noexcept
     {
         return g_variant_new_string(string.c_str());
     }
+
+    static GVariant *serialize(String &&string)
+    {
+        if constexpr (is_dbus_movable_type_v<String>) {
+            if (!g_utf8_validate_len(string.data(), string.size(), nullptr)) {
+                GIO_DBUS_CPP_THROW_ERROR("Attempt to serialize a string that is not valid UTF-8 "
+                                         "or contains a nul character");
+            }
+
+            /* The string is moved to the heap and its buffer including the terminating nul
+             * becomes the GVariant storage, it is released with the last reference */
+            auto *owned = new String(std::move(string));
+            GBytes *bytes = g_bytes_new_with_free_func(owned->data(),
+                                                       owned->size() + 1,
+                                                       &release,
+                                                       owned);
+
+            GVariant *variant = g_variant_new_from_bytes(G_VARIANT_TYPE_STRING, bytes, true);
+            g_bytes_unref(bytes);
+
+            return variant;
+        } else {
+            return serialize(static_cast<const String &>(string));
+        }
+    }
+
+private:
+    static void release(void *string) noexcept
+    {
+        delete static_cast<String *>(string);
+    }
 };
 
-template<typename T, typename Allocator>
-struct DBusSerializer<std::vector<T, Allocator>>
+template<>
+struct DBusSerializer<std::string_view>
 {
-    using Vector = std::vector<T, Allocator>;
-
-    static GVariant *serialize(const Vector &vector) noexcept
+    static GVariant *serialize(std::string_view string) noexcept
     {
-        GVariantBuilder builder;
-        g_variant_builder_init(&builder, dbus_type_to_variant_type_v<Vector>);
+        return g_variant_new_take_string(g_strndup(string.data(), string.size()));
+    }
+};
 
-        for (const T &value: vector) {
-            g_variant_builder_add_value(&builder, DBusSerializer<T>::serialize(value));
+/* Contiguous arrays of trivial types are copied as a whole, other arrays element by element */
+template<typename Range, typename T>
+struct DBusArraySerializer
+{
+    static GVariant *serialize(const Range &range) noexcept
+    {
+        if constexpr (is_dbus_trivial_type_v<T>
+                      && std::contiguous_iterator<decltype(std::begin(range))>) {
+            return g_variant_new_fixed_array(dbus_type_to_variant_type_v<T>,
+                                             std::data(range),
+                                             std::size(range),
+                                             sizeof(T));
+        } else {
+            GVariantBuilder builder;
+            g_variant_builder_init(&builder, dbus_type_to_variant_type_v<Range>);
+
+            for (const T &value: range) {
+                g_variant_builder_add_value(&builder, DBusSerializer<T>::serialize(value));
+            }
+
+            return g_variant_builder_end(&builder);
         }
-
-        return g_variant_builder_end(&builder);
     }
 };
 
-template<typename K, typename V, typename Hash, typename Pred, typename Allocator>
-struct DBusSerializer<std::unordered_map<K, V, Hash, Pred, Allocator>>
+template<typename Map, typename K, typename V>
+struct DBusDictSerializer
 {
-    using Map = std::unordered_map<K, V, Hash, Pred, Allocator>;
-
     static GVariant *serialize(const Map &map) noexcept
     {
         GVariantBuilder builder;
@@ -147,6 +204,78 @@ struct DBusSerializer<std::unordered_map<K, V, Hash, Pred, Allocator>>
     }
 };
 
+template<typename T, typename Allocator>
+struct DBusSerializer<std::vector<T, Allocator>>: DBusArraySerializer<std::vector<T, Allocator>, T>
+{
+    using Vector = std::vector<T, Allocator>;
+    using DBusArraySerializer<Vector, T>::serialize;
+
+    static GVariant *serialize(Vector &&vector)
+    {
+        if constexpr (is_dbus_trivial_type_v<T>
+                      && std::allocator_traits<Allocator>::is_always_equal::value) {
+            /* The vector is moved to the heap and its buffer becomes the GVariant storage,
+             * it is released together with the last reference to the GVariant */
+            auto *owned = new Vector(std::move(vector));
+            GBytes *bytes = g_bytes_new_with_free_func(owned->data(),
+                                                       owned->size() * sizeof(T),
+                                                       &release,
+                                                       owned);
+
+            GVariant *variant = g_variant_new_from_bytes(dbus_type_to_variant_type_v<Vector>,
+                                                         bytes,
+                                                         true);
+            g_bytes_unref(bytes);
+
+            return variant;
+        } else {
+            return serialize(static_cast<const Vector &>(vector));
+        }
+    }
+
+private:
+    static void release(void *vector) noexcept
+    {
+        delete static_cast<Vector *>(vector);
+    }
+};
+
+template<typename T, size_t N>
+struct DBusSerializer<std::array<T, N>>: DBusArraySerializer<std::array<T, N>, T>
+{};
+
+/* Spans are serialize-only, the elements are copied straight from the viewed memory */
+template<typename T, size_t Extent>
+struct DBusSerializer<std::span<T, Extent>>
+    : DBusArraySerializer<std::span<T, Extent>, std::remove_const_t<T>>
+{};
+
+template<typename T, typename Allocator>
+struct DBusSerializer<std::deque<T, Allocator>>: DBusArraySerializer<std::deque<T, Allocator>, T>
+{};
+
+template<typename K, typename V, typename Hash, typename Pred, typename Allocator>
+struct DBusSerializer<std::unordered_map<K, V, Hash, Pred, Allocator>>
+    : DBusDictSerializer<std::unordered_map<K, V, Hash, Pred, Allocator>, K, V>
+{};
+
+template<typename K, typename V, typename Compare, typename Allocator>
+struct DBusSerializer<std::map<K, V, Compare, Allocator>>
+    : DBusDictSerializer<std::map<K, V, Compare, Allocator>, K, V>
+{};
+
+template<typename K, typename V>
+struct DBusSerializer<std::pair<K, V>>
+{
+    static GVariant *serialize(const std::pair<K, V> &pair) noexcept
+    {
+        GVariant *members[] = {DBusSerializer<K>::serialize(pair.first),
+                               DBusSerializer<V>::serialize(pair.second)};
+
+        return g_variant_new_tuple(members, 2);
+    }
+};
+
 template<typename... T>
 struct DBusSerializer<std::tuple<T...>>
 {
@@ -165,20 +294,40 @@ private:
         g_variant_builder_init(&builder, dbus_type_to_variant_type_v<Tuple>);
 
         (g_variant_builder_add_value(&builder,
-                                     DBusSerializer<std::tuple_element_t<I, Tuple>>::serialize(
-                                         std::get<I>(tuple))),
+                                     DBusSerializer<std::remove_cvref_t<std::tuple_element_t<
+                                         I, Tuple>>>::serialize(std::get<I>(tuple))),
          ...);
 
         return g_variant_builder_end(&builder);
     }
 };
 
+template<typename... T>
+struct DBusSerializer<std::variant<T...>>
+{
+    static GVariant *serialize(const std::variant<T...> &variant)
+    {
+        return g_variant_new_variant(std::visit(
+            []<typename A>(const A &value) { return DBusSerializer<A>::serialize(value); },
+            variant));
+    }
+};
+
 template<>
 struct DBusSerializer<ObjectPath>
 {
     static GVariant *serialize(const ObjectPath &object_path) noexcept
     {
-        return g_variant_new_object_path(object_path.as_string().c_str());
+        return g_variant_new_object_path(object_path.c_str());
+    }
+};
+
+template<>
+struct DBusSerializer<ObjectPathView>
+{
+    static GVariant *serialize(const ObjectPathView &object_path) noexcept
+    {
+        return g_variant_new_object_path(object_path.as_string_view().data());
     }
 };
 
@@ -187,7 +336,16 @@ struct DBusSerializer<Signature>
 {
     static GVariant *serialize(const Signature &signature) noexcept
     {
-        return g_variant_new_signature(signature.as_string().c_str());
+        return g_variant_new_signature(signature.c_str());
+    }
+};
+
+template<>
+struct DBusSerializer<SignatureView>
+{
+    static GVariant *serialize(const SignatureView &signature) noexcept
+    {
+        return g_variant_new_signature(signature.as_string_view().data());
     }
 };
 
@@ -200,6 +358,34 @@ struct DBusSerializer<UnixFD>
     }
 };
 
+template<DBusStructType T>
+struct DBusSerializer<T>
+{
+    static GVariant *serialize(const T &value) noexcept
+    {
+        return DBusSerializer<decltype(dbus_struct_tie(value))>::serialize(dbus_struct_tie(value));
+    }
+};
+
+/* Hands a movable value over as the only argument of a message. The last member of a structure
+ * has no framing offset, so the serialized (T) is the serialized value itself and shares its
+ * bytes, a tuple built in tree form would copy them as soon as it gets serialized */
+template<typename T>
+    requires is_dbus_movable_type_v<T>
+GVariant *dbus_serialize_argument(T &&value)
+{
+    GVariant *argument = g_variant_ref_sink(DBusSerializer<T>::serialize(std::move(value)));
+    GBytes *bytes = g_variant_get_data_as_bytes(argument);
+
+    GVariant *tuple = g_variant_new_from_bytes(dbus_type_to_variant_type_v<std::tuple<T>>,
+                                               bytes,
+                                               true);
+    g_bytes_unref(bytes);
+    g_variant_unref(argument);
+
+    return tuple;
+}
+
 } /* namespace Gio::DBus::Details */
 
 #endif /* GIO_DBUS_CPP_DETAILS_DBUS_TYPE_SERIALIZER_HPP */
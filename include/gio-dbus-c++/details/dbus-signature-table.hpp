@@ -0,0 +1,81 @@
+#ifndef GIO_DBUS_CPP_DETAILS_DBUS_SIGNATURE_TABLE_HPP
+#define GIO_DBUS_CPP_DETAILS_DBUS_SIGNATURE_TABLE_HPP
+
+#include "../common.hpp"
+
+#include "dbus-type-traits.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <gio/gio.h>
+#include <string>
+#include <string_view>
+
+namespace Gio::DBus::Details {
+
+/* Signature seen by the process, every distinct string is interned once and lives until the
+ * process exits, so interned signatures are compared by their addresses. The exemplars are
+ * empty GVariant instances keeping the GLib type information of the signature alive, GLib
+ * shares it between all values of the type, so the type of a value is compared with the
+ * signature by the address first. */
+struct DBusInternedSignature
+{
+    std::string signature;
+    size_t hash;
+    GVariant *exemplar;
+    GVariant *tuple_exemplar;
+    std::atomic<const DBusInternedSignature *> next;
+};
+
+/* Process-wide table of interned signatures. Lookups of signatures already seen walk the
+ * table without locking, new signatures are validated and inserted under a mutex and never
+ * removed, intern() returns nullptr for strings that are not valid signatures. */
+class GIO_DBUS_CPP_EXPORT_CLASS(DBusSignatureTable)
+{
+public:
+    static const DBusInternedSignature *intern(std::string_view signature);
+};
+
+inline bool dbus_is_of_exemplar_type(GVariant *value, GVariant *exemplar) noexcept
+{
+    if (!exemplar) {
+        return false;
+    }
+
+    const GVariantType *type = g_variant_get_type(value);
+    const GVariantType *exemplar_type = g_variant_get_type(exemplar);
+
+    return type == exemplar_type || g_variant_type_equal(type, exemplar_type);
+}
+
+/* Whether the type of the value is the single complete type of the signature */
+inline bool dbus_is_of_signature(GVariant *value, const DBusInternedSignature *signature) noexcept
+{
+    return dbus_is_of_exemplar_type(value, signature->exemplar);
+}
+
+/* Whether the value is a tuple of the values of the signature, e.g. the body of a message */
+inline bool dbus_is_of_tuple_signature(GVariant *value,
+                                       const DBusInternedSignature *signature) noexcept
+{
+    return dbus_is_of_exemplar_type(value, signature->tuple_exemplar);
+}
+
+template<typename T>
+const DBusInternedSignature *dbus_interned_signature()
+{
+    static const DBusInternedSignature *const signature = DBusSignatureTable::intern(
+        DBusType<T>::name.data());
+
+    return signature;
+}
+
+template<typename T>
+bool dbus_is_of_type(GVariant *value)
+{
+    return dbus_is_of_signature(value, dbus_interned_signature<T>());
+}
+
+} /* namespace Gio::DBus::Details */
+
+#endif /* GIO_DBUS_CPP_DETAILS_DBUS_SIGNATURE_TABLE_HPP */
@@ -3,17 +3,29 @@
 
 #include "compile-time-string.hpp"
 
+#include <array>
 #include <cstdint>
+#include <deque>
 #include <gio/gio.h>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <span>
 #include <string>
+#include <string_view>
 #include <tuple>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <variant>
 #include <vector>
 
 namespace Gio::DBus {
 
 class ObjectPath;
+class ObjectPathView;
 class Signature;
+class SignatureView;
 class UnixFD;
 
 } /* namespace Gio::DBus */
@@ -87,11 +99,30 @@ struct DBusType<double>: std::true_type
     static constexpr auto class_name = "double"_cts;
 };
 
+template<typename Allocator>
+constexpr auto dbus_string_class_name() noexcept
+{
+    if constexpr (std::is_same_v<Allocator, std::allocator<char>>) {
+        return "std::string"_cts;
+    } else if constexpr (std::is_same_v<Allocator, std::pmr::polymorphic_allocator<char>>) {
+        return "std::pmr::string"_cts;
+    } else {
+        return "std::basic_string<char, std::char_traits<char>, Allocator>"_cts;
+    }
+}
+
+template<typename Allocator>
+struct DBusType<std::basic_string<char, std::char_traits<char>, Allocator>>: std::true_type
+{
+    static constexpr auto name = "s"_cts;
+    static constexpr auto class_name = dbus_string_class_name<Allocator>();
+};
+
 template<>
-struct DBusType<std::string>: std::true_type
+struct DBusType<std::string_view>: std::true_type
 {
     static constexpr auto name = "s"_cts;
-    static constexpr auto class_name = "std::string"_cts;
+    static constexpr auto class_name = "std::string_view"_cts;
 };
 
 template<typename T, typename Allocator>
@@ -103,6 +134,33 @@ struct DBusType<std::vector<T, Allocator>>: std::true_type
     /* clang-format on */
 };
 
+template<typename T, size_t Extent>
+struct DBusType<std::span<T, Extent>>: std::true_type
+{
+    /* clang-format off */
+    static constexpr auto name = "a"_cts + DBusType<std::remove_const_t<T>>::name;
+    static constexpr auto class_name = "std::span<"_cts + DBusType<std::remove_const_t<T>>::class_name + ">"_cts;
+    /* clang-format on */
+};
+
+template<typename T, size_t N>
+struct DBusType<std::array<T, N>>: std::true_type
+{
+    /* clang-format off */
+    static constexpr auto name = "a"_cts + DBusType<T>::name;
+    static constexpr auto class_name = "std::array<"_cts + DBusType<T>::class_name + ">"_cts;
+    /* clang-format on */
+};
+
+template<typename T, typename Allocator>
+struct DBusType<std::deque<T, Allocator>>: std::true_type
+{
+    /* clang-format off */
+    static constexpr auto name = "a"_cts + DBusType<T>::name;
+    static constexpr auto class_name = "std::deque<"_cts + DBusType<T>::class_name + ">"_cts;
+    /* clang-format on */
+};
+
 template<typename K, typename V, typename Hash, typename Pred, typename Allocator>
 struct DBusType<std::unordered_map<K, V, Hash, Pred, Allocator>>: std::true_type
 {
@@ -112,15 +170,117 @@ struct DBusType<std::unordered_map<K, V, Hash, Pred, Allocator>>: std::true_type
     /* clang-format on */
 };
 
+template<typename K, typename V, typename Compare, typename Allocator>
+struct DBusType<std::map<K, V, Compare, Allocator>>: std::true_type
+{
+    /* clang-format off */
+    static constexpr auto name = "a{"_cts + DBusType<K>::name + DBusType<V>::name + "}"_cts;
+    static constexpr auto class_name = "std::map<"_cts + DBusType<K>::class_name + ", "_cts + DBusType<V>::class_name + ">"_cts;
+    /* clang-format on */
+};
+
+/* Pairs are structures of two members, dictionaries are std::map or std::unordered_map */
+template<typename K, typename V>
+struct DBusType<std::pair<K, V>>: std::true_type
+{
+    /* clang-format off */
+    static constexpr auto name = "("_cts + DBusType<K>::name + DBusType<V>::name + ")"_cts;
+    static constexpr auto class_name = "std::pair<"_cts + DBusType<K>::class_name + ", "_cts + DBusType<V>::class_name + ">"_cts;
+    /* clang-format on */
+};
+
+/* Tuples of references (std::forward_as_tuple) describe the same structure as tuples of values */
 template<typename T, typename... R>
 struct DBusType<std::tuple<T, R...>>: std::true_type
 {
     /* clang-format off */
-    static constexpr auto name = "("_cts + (DBusType<T>::name + ... + DBusType<R>::name) + ")"_cts;
-    static constexpr auto class_name = "std::tuple<"_cts + (DBusType<T>::class_name + ... + (", "_cts + DBusType<R>::class_name)) + ">"_cts;
+    static constexpr auto name = "("_cts + (DBusType<std::remove_cvref_t<T>>::name + ... + DBusType<std::remove_cvref_t<R>>::name) + ")"_cts;
+    static constexpr auto class_name = "std::tuple<"_cts + (DBusType<std::remove_cvref_t<T>>::class_name + ... + (", "_cts + DBusType<std::remove_cvref_t<R>>::class_name)) + ">"_cts;
     /* clang-format on */
 };
 
+/* std::variant is carried in a dbus variant, the alternative is chosen by the type of the value */
+template<typename T, typename... R>
+struct DBusType<std::variant<T, R...>>: std::true_type
+{
+    /* clang-format off */
+    static constexpr auto name = "v"_cts;
+    static constexpr auto class_name = "std::variant<"_cts + (DBusType<T>::class_name + ... + (", "_cts + DBusType<R>::class_name)) + ">"_cts;
+    /* clang-format on */
+};
+
+/* User structures map to dbus structures through their members, the trait is specialized with
+ * a tuple of member pointers in the order of the dbus structure and the name of the type:
+ *
+ *     template<>
+ *     struct Gio::DBus::Details::DBusStruct<Point>
+ *     {
+ *         static constexpr auto members = std::make_tuple(&Point::x, &Point::y);
+ *         static constexpr auto class_name = "Point"_cts;
+ *     };
+ *
+ * or with GIO_DBUS_CPP_DECLARE_DBUS_STRUCT(Point, &Point::x, &Point::y) at the global
+ * namespace. The members are then read and written in place, without a std::tuple copy. */
+template<typename T>
+struct DBusStruct
+{};
+
+template<typename T>
+concept DBusStructType = requires {
+    DBusStruct<T>::members;
+    DBusStruct<T>::class_name;
+};
+
+template<typename P>
+struct DBusMemberPointer
+{};
+
+template<typename C, typename M>
+struct DBusMemberPointer<M C::*>
+{
+    using type = M;
+};
+
+template<typename Pointers>
+struct DBusStructMembers
+{};
+
+template<typename... P>
+struct DBusStructMembers<std::tuple<P...>>
+{
+    using type = std::tuple<typename DBusMemberPointer<P>::type...>;
+};
+
+/* std::tuple of the member types of a user structure */
+template<typename T>
+using dbus_struct_tuple_t =
+    typename DBusStructMembers<std::remove_cv_t<decltype(DBusStruct<T>::members)>>::type;
+
+template<typename T>
+constexpr size_t dbus_struct_size_v = std::tuple_size_v<dbus_struct_tuple_t<T>>;
+
+template<DBusStructType T, size_t I>
+constexpr auto dbus_struct_member_v = std::get<I>(DBusStruct<T>::members);
+
+/* Tuple of references to the members of a user structure */
+template<DBusStructType T>
+constexpr auto dbus_struct_tie(const T &value) noexcept
+{
+    return std::apply(
+        [&value](auto... members) {
+            return std::tuple<const typename DBusMemberPointer<decltype(members)>::type &...>(
+                value.*members...);
+        },
+        DBusStruct<T>::members);
+}
+
+template<DBusStructType T>
+struct DBusType<T>: std::true_type
+{
+    static constexpr auto name = DBusType<dbus_struct_tuple_t<T>>::name;
+    static constexpr auto class_name = DBusStruct<T>::class_name;
+};
+
 template<>
 struct DBusType<ObjectPath>: std::true_type
 {
@@ -130,6 +290,15 @@ struct DBusType<ObjectPath>: std::true_type
     /* clang-format on */
 };
 
+template<>
+struct DBusType<ObjectPathView>: std::true_type
+{
+    /* clang-format off */
+    static constexpr auto name = "o"_cts;
+    static constexpr auto class_name = "Gio::DBus::ObjectPathView"_cts;
+    /* clang-format on */
+};
+
 template<>
 struct DBusType<Signature>: std::true_type
 {
@@ -139,6 +308,15 @@ struct DBusType<Signature>: std::true_type
     /* clang-format on */
 };
 
+template<>
+struct DBusType<SignatureView>: std::true_type
+{
+    /* clang-format off */
+    static constexpr auto name = "g"_cts;
+    static constexpr auto class_name = "Gio::DBus::SignatureView"_cts;
+    /* clang-format on */
+};
+
 template<>
 struct DBusType<UnixFD>: std::true_type
 {
@@ -151,10 +329,124 @@ struct DBusType<UnixFD>: std::true_type
 template<typename T>
 constexpr bool is_dbus_type_v = DBusType<std::decay_t<T>>::value;
 
+/* Fixed-size basic types whose C++ representation matches the GVariant serialized form
+ * byte for byte, so contiguous buffers of them can be handed to GVariant as is. The 'b'
+ * type is excluded: std::vector<bool> is bit-packed and bool has no byte-level guarantee. */
+template<typename T>
+constexpr bool is_dbus_trivial_type_v = is_dbus_type_v<T> && std::is_arithmetic_v<T>
+                                        && !std::is_same_v<T, bool>;
+
+/* Types that point into the serialized data of the GVariant they were read from instead of
+ * owning a copy (std::span<const T>, std::string_view, Gio::DBus::ObjectPathView and
+ * Gio::DBus::SignatureView), they are valid only as long as that GVariant is alive. */
+template<typename T>
+struct DBusViewType: std::false_type
+{};
+
+template<typename T>
+struct DBusViewType<std::span<const T>>: std::true_type
+{};
+
+template<>
+struct DBusViewType<std::string_view>: std::true_type
+{};
+
+template<>
+struct DBusViewType<ObjectPathView>: std::true_type
+{};
+
+template<>
+struct DBusViewType<SignatureView>: std::true_type
+{};
+
+template<typename T, typename Allocator>
+struct DBusViewType<std::vector<T, Allocator>>: DBusViewType<T>
+{};
+
+template<typename T, size_t N>
+struct DBusViewType<std::array<T, N>>: DBusViewType<T>
+{};
+
+template<typename T, typename Allocator>
+struct DBusViewType<std::deque<T, Allocator>>: DBusViewType<T>
+{};
+
+template<typename K, typename V, typename Hash, typename Pred, typename Allocator>
+struct DBusViewType<std::unordered_map<K, V, Hash, Pred, Allocator>>
+    : std::disjunction<DBusViewType<K>, DBusViewType<V>>
+{};
+
+template<typename K, typename V, typename Compare, typename Allocator>
+struct DBusViewType<std::map<K, V, Compare, Allocator>>
+    : std::disjunction<DBusViewType<K>, DBusViewType<V>>
+{};
+
+template<typename K, typename V>
+struct DBusViewType<std::pair<K, V>>: std::disjunction<DBusViewType<K>, DBusViewType<V>>
+{};
+
+template<typename... T>
+struct DBusViewType<std::tuple<T...>>: std::disjunction<DBusViewType<T>...>
+{};
+
+template<typename... T>
+struct DBusViewType<std::variant<T...>>: std::disjunction<DBusViewType<T>...>
+{};
+
+/* User structures with a view member, e.g. std::string_view, can only be read with view() */
+template<DBusStructType T>
+struct DBusViewType<T>: DBusViewType<dbus_struct_tuple_t<T>>
+{};
+
+template<typename T>
+constexpr bool is_dbus_view_type_v = DBusViewType<std::decay_t<T>>::value;
+
+/* Types owning one heap buffer that the rvalue serializers hand over to GVariant instead of
+ * copying it: strings and vectors of trivial types with stateless allocators. Values containing
+ * them are encoded, handing over their buffers one by one costs more than copying them. */
+template<typename T>
+struct DBusMovableType: std::false_type
+{};
+
+template<typename Allocator>
+struct DBusMovableType<std::basic_string<char, std::char_traits<char>, Allocator>>
+    : std::bool_constant<std::allocator_traits<Allocator>::is_always_equal::value>
+{};
+
+template<typename T, typename Allocator>
+struct DBusMovableType<std::vector<T, Allocator>>
+    : std::bool_constant<is_dbus_trivial_type_v<T>
+                         && std::allocator_traits<Allocator>::is_always_equal::value>
+{};
+
+template<typename T>
+constexpr bool is_dbus_movable_type_v = DBusMovableType<std::decay_t<T>>::value;
+
+/* Smaller buffers are copied, which is cheaper than the allocations keeping a handed over
+ * buffer alive */
+constexpr size_t dbus_movable_min_size = 4096;
+
+template<typename T>
+    requires is_dbus_movable_type_v<T>
+bool dbus_is_worth_moving(const T &value) noexcept
+{
+    return value.size() * sizeof(typename T::value_type) >= dbus_movable_min_size;
+}
+
 template<typename T>
 const GVariantType *dbus_type_to_variant_type_v = reinterpret_cast<const GVariantType *>(
     DBusType<T>::name.data());
 
 } /* namespace Gio::DBus::Details */
 
+/* NOLINTBEGIN(bugprone-macro-parentheses) */
+#define GIO_DBUS_CPP_DECLARE_DBUS_STRUCT(Type, ...)                                      \
+    template<>                                                                           \
+    struct Gio::DBus::Details::DBusStruct<Type>                                          \
+    {                                                                                    \
+        static constexpr auto members = std::make_tuple(__VA_ARGS__);                    \
+        static constexpr auto class_name = Gio::DBus::Details::CompileTimeString(#Type); \
+    };
+/* NOLINTEND(bugprone-macro-parentheses) */
+
 #endif /* GIO_DBUS_CPP_DETAILS_DBUS_TYPE_TRAITS_HPP */
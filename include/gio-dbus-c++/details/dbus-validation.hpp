@@ -0,0 +1,147 @@
+#ifndef GIO_DBUS_CPP_DETAILS_DBUS_VALIDATION_HPP
+#define GIO_DBUS_CPP_DETAILS_DBUS_VALIDATION_HPP
+
+#include <cstddef>
+#include <string_view>
+
+namespace Gio::DBus::Details {
+
+/* Object paths are "/" or "/" separated non-empty elements made of [A-Za-z0-9_] */
+constexpr bool dbus_is_object_path(std::string_view object_path) noexcept
+{
+    if (object_path.empty() || object_path.front() != '/') {
+        return false;
+    }
+
+    if (object_path.size() == 1) {
+        return true;
+    }
+
+    if (object_path.back() == '/') {
+        return false;
+    }
+
+    for (size_t i = 1; i < object_path.size(); ++i) {
+        const char c = object_path[i];
+
+        if (c == '/') {
+            if (object_path[i - 1] == '/') {
+                return false;
+            }
+        } else if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+                     || c == '_')) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Signatures are sequences of complete types of at most 255 characters with at most 32
+ * nested arrays and 32 nested structures. Dict entries appear only as array elements and
+ * have a basic key and a value. Containers are tracked with an explicit stack. */
+constexpr bool dbus_is_signature(std::string_view signature) noexcept
+{
+    constexpr size_t max_size = 255;
+    constexpr size_t max_depth = 32;
+
+    struct Frame
+    {
+        char kind;
+        size_t members;
+    };
+
+    if (signature.size() > max_size) {
+        return false;
+    }
+
+    Frame frames[max_size] = {};
+    size_t depth = 0;
+    size_t arrays = 0;
+    size_t structs = 0;
+
+    for (const char c: signature) {
+        bool is_basic = false;
+
+        switch (c) {
+        case 'a':
+            if (++arrays > max_depth) {
+                return false;
+            }
+
+            frames[depth++] = {'a', 0};
+            continue;
+        case '(':
+            if (++structs > max_depth) {
+                return false;
+            }
+
+            frames[depth++] = {'(', 0};
+            continue;
+        case '{':
+            if (!depth || frames[depth - 1].kind != 'a') {
+                return false;
+            }
+
+            frames[depth++] = {'{', 0};
+            continue;
+        case ')':
+            if (!depth || frames[depth - 1].kind != '(' || !frames[depth - 1].members) {
+                return false;
+            }
+
+            --depth;
+            --structs;
+            break;
+        case '}':
+            if (!depth || frames[depth - 1].kind != '{' || frames[depth - 1].members != 2) {
+                return false;
+            }
+
+            --depth;
+            break;
+        case 'y':
+        case 'b':
+        case 'n':
+        case 'q':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 't':
+        case 'd':
+        case 'h':
+        case 's':
+        case 'o':
+        case 'g':
+            is_basic = true;
+            break;
+        case 'v':
+            break;
+        default:
+            return false;
+        }
+
+        /* A complete type also completes the arrays waiting for their element type */
+        while (depth && frames[depth - 1].kind == 'a') {
+            --depth;
+            --arrays;
+            is_basic = false;
+        }
+
+        if (depth) {
+            Frame &frame = frames[depth - 1];
+
+            if (frame.kind == '{' && (frame.members == 2 || (!frame.members && !is_basic))) {
+                return false;
+            }
+
+            ++frame.members;
+        }
+    }
+
+    return depth == 0;
+}
+
+} /* namespace Gio::DBus::Details */
+
+#endif /* GIO_DBUS_CPP_DETAILS_DBUS_VALIDATION_HPP */
@@ -0,0 +1,126 @@
+#ifndef GIO_DBUS_CPP_DETAILS_SMALL_STRING_HPP
+#define GIO_DBUS_CPP_DETAILS_SMALL_STRING_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+namespace Gio::DBus::Details {
+
+/* Nul-terminated string stored inline up to InlineCapacity characters and on the heap
+ * otherwise. Object paths and signatures are short, so most of them are created and copied
+ * without allocations. */
+class SmallString
+{
+public:
+    static constexpr size_t InlineCapacity = 63;
+
+    SmallString() noexcept
+        : m_size(0)
+    {
+        m_inline[0] = '\0';
+    }
+
+    explicit SmallString(std::string_view string)
+        : m_size(string.size())
+    {
+        char *data = m_inline;
+
+        if (is_on_heap()) {
+            data = m_heap = new char[m_size + 1];
+        }
+
+        if (m_size) {
+            std::memcpy(data, string.data(), m_size);
+        }
+
+        data[m_size] = '\0';
+    }
+
+    SmallString(const SmallString &other)
+        : SmallString(other.view())
+    {}
+
+    SmallString(SmallString &&other) noexcept
+        : m_size(0)
+    {
+        take(other);
+    }
+
+    SmallString &operator=(const SmallString &other)
+    {
+        if (this != &other) {
+            *this = SmallString(other);
+        }
+
+        return *this;
+    }
+
+    SmallString &operator=(SmallString &&other) noexcept
+    {
+        if (this != &other) {
+            release();
+            take(other);
+        }
+
+        return *this;
+    }
+
+    ~SmallString()
+    {
+        release();
+    }
+
+    const char *c_str() const noexcept
+    {
+        return is_on_heap() ? m_heap : m_inline;
+    }
+
+    size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    std::string_view view() const noexcept
+    {
+        return {c_str(), m_size};
+    }
+
+private:
+    bool is_on_heap() const noexcept
+    {
+        return m_size > InlineCapacity;
+    }
+
+    void take(SmallString &other) noexcept
+    {
+        m_size = other.m_size;
+
+        if (other.is_on_heap()) {
+            m_heap = other.m_heap;
+        } else {
+            std::memcpy(m_inline, other.m_inline, m_size + 1);
+        }
+
+        other.m_size = 0;
+        other.m_inline[0] = '\0';
+    }
+
+    void release() noexcept
+    {
+        if (is_on_heap()) {
+            delete[] m_heap;
+        }
+    }
+
+    size_t m_size;
+
+    union {
+        char *m_heap;
+        char m_inline[InlineCapacity + 1];
+    };
+};
+
+} /* namespace Gio::DBus::Details */
+
+#endif /* GIO_DBUS_CPP_DETAILS_SMALL_STRING_HPP */
@@ -1,9 +1,14 @@
 #ifndef GIO_DBUS_CPP_GIO_DBUS_CPP_HPP
 #define GIO_DBUS_CPP_GIO_DBUS_CPP_HPP
 
+#include "columns.hpp"
 #include "connection.hpp"
+#include "decode-limits.hpp"
 #include "context.hpp"
+#include "lazy.hpp"
+#include "proxy-flags.hpp"
 #include "proxy.hpp"
+#include "signal-match.hpp"
 #include "variant.hpp"
 
 #endif /* GIO_DBUS_CPP_GIO_DBUS_CPP_HPP */
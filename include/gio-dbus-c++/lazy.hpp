@@ -0,0 +1,282 @@
+#ifndef GIO_DBUS_CPP_LAZY_HPP
+#define GIO_DBUS_CPP_LAZY_HPP
+
+#include "details/dbus-decode-limits.hpp"
+#include "details/dbus-deserializer.hpp"
+#include "details/dbus-signature-table.hpp"
+#include "details/dbus-type-traits.hpp"
+#include "details/exception.hpp"
+#include "variant.hpp"
+
+#include <gio/gio.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace Gio::DBus {
+
+class Message;
+
+/* Typed view over a part of a message that decodes nothing until it is asked to. Structures,
+ * arrays and dictionaries give access to their children as Lazy values, so reading a couple
+ * of fields of a large reply only decodes these fields. Every Lazy value keeps the message
+ * data alive, taking a child of a serialized message does not copy the data. */
+template<typename T>
+class Lazy;
+
+namespace Details {
+
+template<typename T>
+class LazyValue
+{
+public:
+    T value() const
+    {
+        static_assert(!is_dbus_view_type_v<T>,
+                      "Attempt to read a value of type T using Gio::DBus::Lazy<T>::value(), "
+                      "but T borrows from the message");
+
+        const DBusDecodeScope scope(m_decode_limits);
+        return DBusDeserializer<T>::deserialize(as_gio_variant());
+    }
+
+    void value_into(T &value) const
+    {
+        const DBusDecodeScope scope(m_decode_limits);
+        dbus_deserialize_into(as_gio_variant(), value);
+    }
+
+    LazyValue(const LazyValue &other) noexcept
+        : m_variant(reference(other.as_gio_variant()), &g_variant_unref)
+        , m_decode_limits(other.m_decode_limits)
+    {}
+
+    LazyValue(LazyValue &&other) noexcept = default;
+
+    LazyValue &operator=(const LazyValue &other) noexcept
+    {
+        m_variant.reset(reference(other.as_gio_variant()));
+        m_decode_limits = other.m_decode_limits;
+        return *this;
+    }
+
+    LazyValue &operator=(LazyValue &&other) noexcept = default;
+
+    ~LazyValue() = default;
+
+protected:
+    template<typename U>
+    friend class Gio::DBus::Lazy;
+
+    template<typename U>
+    friend class LazyValue;
+
+    friend class Gio::DBus::Message;
+
+    /* Takes the ownership of a full reference, the part is read within the limits left to it
+     * by the message it comes from */
+    LazyValue(GVariant *variant, const DecodeLimits &limits) noexcept
+        : m_variant(variant, &g_variant_unref)
+        , m_decode_limits(limits)
+    {}
+
+    GVariant *as_gio_variant() const noexcept
+    {
+        return m_variant.get();
+    }
+
+    template<typename U>
+    Lazy<U> child(size_t index) const noexcept
+    {
+        return Lazy<U>(g_variant_get_child_value(as_gio_variant(), index),
+                       dbus_nested_limits(m_decode_limits));
+    }
+
+    std::unique_ptr<GVariant, decltype(&g_variant_unref)> m_variant;
+    DecodeLimits m_decode_limits;
+
+private:
+    /* A moved-from value has no variant, copying it gives another empty value */
+    static GVariant *reference(GVariant *variant) noexcept
+    {
+        return variant ? g_variant_ref(variant) : nullptr;
+    }
+};
+
+} /* namespace Details */
+
+template<typename T>
+class Lazy: public Details::LazyValue<T>
+{
+    using Details::LazyValue<T>::LazyValue;
+};
+
+template<typename... T>
+class Lazy<std::tuple<T...>>: public Details::LazyValue<std::tuple<T...>>
+{
+public:
+    template<size_t I>
+    Lazy<std::tuple_element_t<I, std::tuple<T...>>> get() const noexcept
+    {
+        return this->template child<std::tuple_element_t<I, std::tuple<T...>>>(I);
+    }
+
+    static constexpr size_t size() noexcept
+    {
+        return sizeof...(T);
+    }
+
+private:
+    using Details::LazyValue<std::tuple<T...>>::LazyValue;
+};
+
+template<typename T, typename Allocator>
+class Lazy<std::vector<T, Allocator>>: public Details::LazyValue<std::vector<T, Allocator>>
+{
+public:
+    size_t size() const noexcept
+    {
+        return g_variant_n_children(this->as_gio_variant());
+    }
+
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    Lazy<T> operator[](size_t index) const noexcept
+    {
+        return this->template child<T>(index);
+    }
+
+    Lazy<T> at(size_t index) const
+    {
+        if (index >= size()) {
+            GIO_DBUS_CPP_THROW_ERROR(
+                std::string("Attempt to access an element of Gio::DBus::Lazy<std::vector> ")
+                + "with index " + std::to_string(index) + ", but the array has "
+                + std::to_string(size()) + " elements");
+        }
+
+        return this->template child<T>(index);
+    }
+
+private:
+    using Details::LazyValue<std::vector<T, Allocator>>::LazyValue;
+};
+
+template<typename K, typename V, typename Hash, typename Pred, typename Allocator>
+class Lazy<std::unordered_map<K, V, Hash, Pred, Allocator>>
+    : public Details::LazyValue<std::unordered_map<K, V, Hash, Pred, Allocator>>
+{
+public:
+    size_t size() const noexcept
+    {
+        return g_variant_n_children(this->as_gio_variant());
+    }
+
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    /* Scans the entries in order and decodes only their keys, string keys are compared with
+     * the serialized data in place */
+    std::optional<Lazy<V>> find(const K &key) const
+    {
+        GVariant *map = this->as_gio_variant();
+        const size_t entries = g_variant_n_children(map);
+
+        for (size_t index = 0; index < entries; ++index) {
+            Details::GVariantUniquePtr entry(g_variant_get_child_value(map, index),
+                                             &g_variant_unref);
+
+            if (key_equals(entry.get(), key)) {
+                return Lazy<V>(g_variant_get_child_value(entry.get(), 1),
+                               Details::dbus_nested_limits(this->m_decode_limits));
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    bool contains(const K &key) const
+    {
+        return find(key).has_value();
+    }
+
+private:
+    using Details::LazyValue<std::unordered_map<K, V, Hash, Pred, Allocator>>::LazyValue;
+
+    static bool key_equals(GVariant *entry, const K &key)
+    {
+        Details::GVariantUniquePtr entry_key(g_variant_get_child_value(entry, 0),
+                                             &g_variant_unref);
+
+        if constexpr (std::is_convertible_v<const K &, std::string_view>) {
+            gsize length = 0;
+            const char *string = g_variant_get_string(entry_key.get(), &length);
+
+            return std::string_view(string, length) == std::string_view(key);
+        } else {
+            return Details::DBusDeserializer<K>::deserialize(entry_key.get()) == key;
+        }
+    }
+};
+
+template<>
+class Lazy<Variant>: public Details::LazyValue<Variant>
+{
+public:
+    template<typename T>
+    bool contains_value_of_type() const
+    {
+        using namespace Details;
+
+        static_assert(is_dbus_type_v<T>,
+                      "Attempt to check whether Gio::DBus::Lazy<Gio::DBus::Variant> stores "
+                      "a value of type T, but T is not a dbus type");
+
+        GVariantUniquePtr child(g_variant_get_variant(as_gio_variant()), &g_variant_unref);
+        return dbus_is_of_type<T>(child.get());
+    }
+
+    /* Unwraps the variant without decoding its value */
+    template<typename T>
+    Lazy<T> as() const
+    {
+        using namespace Details;
+
+        static_assert(is_dbus_type_v<T>,
+                      "Attempt to read a value of type T using "
+                      "Gio::DBus::Lazy<Gio::DBus::Variant>::as<T>(), but T is not a dbus type");
+
+        GVariant *child = g_variant_get_variant(as_gio_variant());
+
+        if (!dbus_is_of_type<T>(child)) {
+            std::string type_signature = g_variant_get_type_string(child);
+            g_variant_unref(child);
+
+            GIO_DBUS_CPP_THROW_ERROR(std::string("Attempt to read a value of type T (aka ")
+                                     + DBusType<T>::class_name.data() + " aka "
+                                     + DBusType<T>::name.data()
+                                     + ") using Gio::DBus::Lazy<Gio::DBus::Variant>::as<T>(), "
+                                     + "but the variant contains value of type "
+                                     + type_signature);
+        }
+
+        return Lazy<T>(child, m_decode_limits);
+    }
+
+private:
+    using Details::LazyValue<Variant>::LazyValue;
+};
+
+} /* namespace Gio::DBus */
+
+#endif /* GIO_DBUS_CPP_LAZY_HPP */
@@ -1,14 +1,26 @@
 #ifndef GIO_DBUS_CPP_MESSAGE_HPP
 #define GIO_DBUS_CPP_MESSAGE_HPP
 
+#include "decode-limits.hpp"
+#include "details/dbus-decode-limits.hpp"
 #include "details/dbus-deserializer.hpp"
+#include "details/dbus-dictionary.hpp"
+#include "details/dbus-encoder.hpp"
 #include "details/dbus-serializer.hpp"
+#include "details/dbus-signature-table.hpp"
 #include "details/dbus-type-traits.hpp"
 #include "details/exception.hpp"
 #include "details/type-traits.hpp"
+#include "lazy.hpp"
 
 #include <gio/gio.h>
 #include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
 
 namespace Gio::DBus {
 
@@ -25,13 +37,38 @@ public:
                       "Attempt to construct Gio::DBus::Message from value of type T using "
                       "Gio::DBus::Message::Message<T>(const T &), but T is not a dbus type");
 
+        try {
+            m_variant.reset(gio_variant_to_owned(encode(value)));
+        }
+        catch (const std::exception &error) {
+            GIO_DBUS_CPP_THROW_ERROR(
+                std::string("Failed to construct Gio::DBus::Message from value of type T (aka ")
+                + DBusType<T>::class_name.data() + " aka " + DBusType<T>::name.data()
+                + ") using Gio::DBus::Message::Message<T>(const T &)" + " (" + error.what() + ")");
+        }
+    }
+
+    /* A large string or buffer of trivial types is handed over to the message instead of being
+     * copied, other values are encoded as by Message(const T &) */
+    template<typename T>
+        requires(!std::is_lvalue_reference_v<T> && !std::is_const_v<std::remove_reference_t<T>>
+                 && Details::is_dbus_type_v<T>)
+    Message(T &&value)
+        : m_variant(nullptr, &g_variant_unref)
+    {
+        using namespace Details;
+
         try {
             GVariant *variant = nullptr;
 
-            if constexpr (is_tuple_type_v<T>) {
-                variant = DBusSerializer<T>::serialize(value);
-            } else {
-                variant = DBusSerializer<std::tuple<T>>::serialize(std::tuple<T>(value));
+            if constexpr (is_dbus_movable_type_v<T>) {
+                if (dbus_is_worth_moving(value)) {
+                    variant = dbus_serialize_argument(std::move(value));
+                }
+            }
+
+            if (!variant) {
+                variant = encode(value);
             }
 
             m_variant.reset(gio_variant_to_owned(variant));
@@ -40,10 +77,22 @@ public:
             GIO_DBUS_CPP_THROW_ERROR(
                 std::string("Failed to construct Gio::DBus::Message from value of type T (aka ")
                 + DBusType<T>::class_name.data() + " aka " + DBusType<T>::name.data()
-                + ") using Gio::DBus::Message::Message<T>(const T &)" + " (" + error.what() + ")");
+                + ") using Gio::DBus::Message::Message<T>(T &&)" + " (" + error.what() + ")");
         }
     }
 
+    /* Builds a message with one argument per value, the values are encoded straight from the
+     * references without being copied into a std::tuple first */
+    template<typename... Args>
+    static Message from(const Args &...arguments)
+    {
+        static_assert(sizeof...(Args) > 0,
+                      "Attempt to construct Gio::DBus::Message using "
+                      "Gio::DBus::Message::from<Args...>(const Args &...) without arguments");
+
+        return Message(std::forward_as_tuple(arguments...));
+    }
+
     template<typename T>
     bool contains_value_of_type() const
     {
@@ -53,7 +102,20 @@ public:
                       "Attempt to check whether Gio::DBus::Message stores a value of type T using "
                       "Gio::DBus::Message::is<T>(), but T is not a dbus type");
 
-        return g_variant_is_of_type(as_gio_variant(), dbus_type_to_variant_type_v<T>);
+        return dbus_is_of_type<T>(as_gio_variant());
+    }
+
+    /* Whether the arguments of the message are the values of the signature, e.g. "sa{sv}" */
+    bool contains_value_of_signature(const Signature &signature) const noexcept
+    {
+        return signature.is_tuple_type_of(as_gio_variant());
+    }
+
+    /* Signature of the arguments of the message, e.g. "sa{sv}" */
+    Signature signature() const
+    {
+        const std::string_view type = dbus_type_signature();
+        return Signature(Details::SmallString(type.substr(1, type.size() - 2)));
     }
 
     template<typename T>
@@ -65,49 +127,266 @@ public:
                       "Attempt to read a value of type T using Gio::DBus::Message::as<T>(), "
                       "but T is not a dbus type");
 
+        static_assert(!is_dbus_view_type_v<T>,
+                      "Attempt to read a value of type T using Gio::DBus::Message::as<T>(), "
+                      "but T borrows from the message, use Gio::DBus::Message::view<T>()");
+
+        return read<T>("as", &deserialize<T>);
+    }
+
+    /* Reads a value without checking the type of the message first, for messages known to
+     * contain T such as replies of our own services. Debug builds still check the type. */
+    template<typename T>
+    T as_unchecked() const
+    {
+        using namespace Details;
+
+        static_assert(is_dbus_type_v<T>,
+                      "Attempt to read a value of type T using "
+                      "Gio::DBus::Message::as_unchecked<T>(), but T is not a dbus type");
+
+        static_assert(!is_dbus_view_type_v<T>,
+                      "Attempt to read a value of type T using "
+                      "Gio::DBus::Message::as_unchecked<T>(), but T borrows from the message, "
+                      "use Gio::DBus::Message::view<T>()");
+
+#ifdef NDEBUG
+        const DBusDecodeScope scope(m_decode_limits);
+        return deserialize<T>(as_gio_variant());
+#else
+        return read<T>("as_unchecked", &deserialize<T>);
+#endif
+    }
+
+    /* Reads a value within the limits instead of the ones of the message, see
+     * Gio::DBus::DecodeLimits */
+    template<typename T>
+    T as(const DecodeLimits &limits) const
+    {
+        using namespace Details;
+
+        static_assert(is_dbus_type_v<T>,
+                      "Attempt to read a value of type T using Gio::DBus::Message::as<T>(limits), "
+                      "but T is not a dbus type");
+
+        static_assert(!is_dbus_view_type_v<T>,
+                      "Attempt to read a value of type T using Gio::DBus::Message::as<T>(limits), "
+                      "but T borrows from the message, use Gio::DBus::Message::view<T>()");
+
+        return read<T>("as", &deserialize<T>, limits);
+    }
+
+    /* Reads a value whose strings and containers, including nested ones, use std::pmr
+     * allocators and allocates all of them from the memory resource, e.g. a monotonic arena
+     * that releases a whole decoded reply at once */
+    template<typename T>
+    T as(std::pmr::memory_resource *resource) const
+    {
+        static_assert(std::is_default_constructible_v<T>,
+                      "Attempt to read a value of type T using "
+                      "Gio::DBus::Message::as<T>(resource), but T is not default constructible");
+
+        T value = std::make_obj_using_allocator<T>(std::pmr::polymorphic_allocator<>(resource));
+        as_into(value);
+
+        return value;
+    }
+
+    /* Reads a value into an existing one, containers and strings are refilled in place and
+     * reuse the memory they already own, which avoids allocations when polling the same data */
+    template<typename T>
+    void as_into(T &value) const
+    {
+        using namespace Details;
+
+        static_assert(is_dbus_type_v<T>,
+                      "Attempt to read a value of type T using Gio::DBus::Message::as_into<T>(), "
+                      "but T is not a dbus type");
+
+        static_assert(!is_dbus_view_type_v<T>,
+                      "Attempt to read a value of type T using Gio::DBus::Message::as_into<T>(), "
+                      "but T borrows from the message, use Gio::DBus::Message::view<T>()");
+
+        read<T>("as_into", [&value](GVariant *variant) {
+            if constexpr (is_tuple_type_v<T>) {
+                dbus_deserialize_into(variant, value);
+            } else {
+                GVariantUniquePtr child(g_variant_get_child_value(variant, 0), &g_variant_unref);
+                dbus_deserialize_into(child.get(), value);
+            }
+        });
+    }
+
+    /* Reads a value that may contain views (std::span<const T> and friends) pointing into the
+     * serialized data of the message. The views stay valid as long as the message is alive. The
+     * first view keeps the arguments alive in the message, so it is not taken from several
+     * threads at once. */
+    template<typename T>
+    T view() const &
+    {
+        using namespace Details;
+
+        static_assert(is_dbus_type_v<T>,
+                      "Attempt to read a value of type T using Gio::DBus::Message::view<T>(), "
+                      "but T is not a dbus type");
+
+        dbus_pin_children(as_gio_variant(), m_viewed_arguments);
+
+        return read<T>("view", &deserialize<T>);
+    }
+
+    template<typename T>
+    T view() const && = delete;
+
+    /* Gives typed access to the parts of the message that decodes only the parts actually
+     * read, e.g. message.lazy<T>().get<0>().find("key")->value(), see Gio::DBus::Lazy */
+    template<typename T>
+    Lazy<T> lazy() const
+    {
+        using namespace Details;
+
+        static_assert(is_dbus_type_v<T>,
+                      "Attempt to read a value of type T using Gio::DBus::Message::lazy<T>(), "
+                      "but T is not a dbus type");
+
+        /* The parts keep the limits of the message, they are read later on their own */
+        return read<T>("lazy", [](GVariant *variant) {
+            const DecodeLimits limits = dbus_decode_remaining_limits();
+
+            if constexpr (is_tuple_type_v<T>) {
+                return Lazy<T>(g_variant_ref(variant), limits);
+            } else {
+                return Lazy<T>(g_variant_get_child_value(variant, 0), dbus_nested_limits(limits));
+            }
+        });
+    }
+
+    /* Looks up a key in the dictionary with string keys passed as the argument at the index
+     * and decodes only the value found, values of a{sv} are unwrapped unless V is
+     * Gio::DBus::Variant. E.g. message.lookup<bool>(1, "Visible") for PropertiesChanged. */
+    template<typename V>
+    std::optional<V> lookup(size_t index, std::string_view key) const
+    {
+        return std::get<0>(lookup_many<V>(index, key));
+    }
+
+    /* Looks up several keys during a single pass over the dictionary */
+    template<typename... V>
+    std::tuple<std::optional<V>...> lookup_many(size_t index,
+                                                Details::DBusDictionaryKey<V>... keys) const
+    {
+        GVariant *message = as_gio_variant();
+
+        if (index >= g_variant_n_children(message)) {
+            GIO_DBUS_CPP_THROW_ERROR("Attempt to look up a value in the argument "
+                                     + std::to_string(index)
+                                     + " of Gio::DBus::Message, but the message contains value "
+                                     + "of type " + dbus_type_signature());
+        }
+
+        Details::GVariantUniquePtr dictionary(g_variant_get_child_value(message, index),
+                                              &g_variant_unref);
+
+        const Details::DBusDecodeScope scope(m_decode_limits);
+        return Details::dbus_dictionary_lookup<V...>(dictionary.get(), {keys...});
+    }
+
+    /* Limits applied to every read of the message, replies received by a proxy carry the
+     * limits of the proxy, see Gio::DBus::Proxy::set_decode_limits() */
+    void set_decode_limits(const DecodeLimits &limits) noexcept
+    {
+        m_decode_limits = limits;
+    }
+
+    const DecodeLimits &decode_limits() const noexcept
+    {
+        return m_decode_limits;
+    }
+
+    /* Whether the message was received from a trusted peer, see
+     * Gio::DBus::Connection::set_trusted_peer() */
+    bool is_trusted() const noexcept
+    {
+        return m_trusted;
+    }
+
+    template<typename T>
+    operator T() const
+    {
+        return as<T>();
+    }
+
+private:
+    friend class ConnectionImpl;
+    friend class ProxyImpl;
+    friend struct MethodCall;
+
+    template<typename T, typename Read>
+    decltype(auto) read(const char *method, const Read &reader) const
+    {
+        return read<T>(method, reader, m_decode_limits);
+    }
+
+    template<typename T, typename Read>
+    decltype(auto) read(const char *method, const Read &reader, const DecodeLimits &limits) const
+    {
+        using namespace Details;
+
+        /* The type of a trusted message is the one expected by the caller */
         if constexpr (is_tuple_type_v<T>) {
-            if (!contains_value_of_type<T>()) {
+            if (!skips_type_checks() && !contains_value_of_type<T>()) {
                 GIO_DBUS_CPP_THROW_ERROR(std::string("Attempt to read a value of type T (aka ")
                                          + DBusType<T>::class_name.data() + " aka "
                                          + DBusType<T>::name.data()
-                                         + ") using Gio::DBus::Message::as<T>(), "
-                                           "but Gio::DBus::Message contains value of type "
+                                         + ") using Gio::DBus::Message::" + method + "<T>(), "
+                                         + "but Gio::DBus::Message contains value of type "
                                          + dbus_type_signature());
             }
         } else {
-            if (!contains_value_of_type<std::tuple<T>>()) {
+            if (!skips_type_checks() && !contains_value_of_type<std::tuple<T>>()) {
                 GIO_DBUS_CPP_THROW_ERROR(
                     std::string("Attempt to read a value of type std::tuple<T> (aka std::tuple<")
                     + DBusType<T>::class_name.data() + "> aka (" + DBusType<T>::name.data()
-                    + ")) using Gio::DBus::Message::as<T>(), "
-                      "but Gio::DBus::Message contains value of type "
-                    + dbus_type_signature());
+                    + ")) using Gio::DBus::Message::" + method + "<T>(), "
+                    + "but Gio::DBus::Message contains value of type " + dbus_type_signature());
             }
         }
 
         try {
-            if constexpr (is_tuple_type_v<T>) {
-                return DBusDeserializer<T>::deserialize(as_gio_variant());
-            } else {
-                return std::get<0>(DBusDeserializer<std::tuple<T>>::deserialize(as_gio_variant()));
-            }
+            const DBusDecodeScope scope(limits);
+            return reader(as_gio_variant());
         }
         catch (const std::exception &error) {
-            GIO_DBUS_CPP_THROW_ERROR(
-                std::string("Failed to read a value of type T (aka ")
-                + DBusType<T>::class_name.data() + " aka " + DBusType<T>::name.data()
-                + ") using Gio::DBus::Message::as<T>() (" + error.what() + ")");
+            GIO_DBUS_CPP_THROW_ERROR(std::string("Failed to read a value of type T (aka ")
+                                     + DBusType<T>::class_name.data() + " aka "
+                                     + DBusType<T>::name.data() + ") using Gio::DBus::Message::"
+                                     + method + "<T>() (" + error.what() + ")");
         }
     }
 
     template<typename T>
-    operator T() const
+    static GVariant *encode(const T &value)
     {
-        return as<T>();
+        using namespace Details;
+
+        if constexpr (is_tuple_type_v<T>) {
+            return dbus_encode(value);
+        } else {
+            return dbus_encode_struct(value);
+        }
     }
 
-private:
-    friend class ProxyImpl;
+    template<typename T>
+    static T deserialize(GVariant *variant)
+    {
+        using namespace Details;
+
+        if constexpr (is_tuple_type_v<T>) {
+            return DBusDeserializer<T>::deserialize(variant);
+        } else {
+            return std::get<0>(DBusDeserializer<std::tuple<T>>::deserialize(variant));
+        }
+    }
 
     Message(GVariant *variant)
         : m_variant(gio_variant_to_owned(variant), &g_variant_unref)
@@ -118,6 +397,23 @@ private:
         }
     }
 
+    /* Data received from a trusted peer is read without type checks in release builds, see
+     * Connection::set_trusted_peer */
+    Message(GVariant *variant, bool trusted)
+        : Message(variant)
+    {
+        m_trusted = trusted;
+    }
+
+    bool skips_type_checks() const noexcept
+    {
+#ifdef NDEBUG
+        return m_trusted;
+#else
+        return false;
+#endif
+    }
+
     const char *dbus_type_signature() const noexcept
     {
         const char *type_signature = g_variant_get_type_string(m_variant.get());
@@ -136,14 +432,13 @@ private:
 
     GVariant *gio_variant_to_owned(GVariant *variant)
     {
-        if (g_variant_is_floating(variant)) {
-            return variant;
-        } else {
-            return g_variant_ref(variant);
-        }
+        return g_variant_ref_sink(variant);
     }
 
     std::unique_ptr<GVariant, decltype(&g_variant_unref)> m_variant;
+    bool m_trusted = false;
+    DecodeLimits m_decode_limits;
+    mutable std::vector<Details::GVariantUniquePtr> m_viewed_arguments;
 };
 
 } /* namespace Gio::DBus */
@@ -1,25 +1,151 @@
 #ifndef GIO_DBUS_CPP_OBJECT_PATH_HPP
 #define GIO_DBUS_CPP_OBJECT_PATH_HPP
 
-#include "common.hpp"
-
-#include "details/pimpl.hpp"
+#include "details/compile-time-string.hpp"
+#include "details/dbus-validation.hpp"
+#include "details/exception.hpp"
+#include "details/small-string.hpp"
 
+#include <compare>
+#include <cstddef>
+#include <functional>
 #include <string>
+#include <string_view>
 
 namespace Gio::DBus {
 
-class ObjectPathImpl;
-class GIO_DBUS_CPP_EXPORT_CLASS(ObjectPath)
+namespace Details {
+
+template<typename T>
+struct DBusDeserializer;
+
+} /* namespace Details */
+
+/* Valid object path stored inline up to Details::SmallString::InlineCapacity characters,
+ * so object paths are created and copied without allocations. Default constructed object
+ * path is "/". */
+class ObjectPath
 {
-    GIO_DBUS_CPP_DECLARE_PIMPL_PARTS(ObjectPath, ObjectPathImpl)
+public:
+    ObjectPath()
+        : m_object_path("/")
+    {}
+
+    ObjectPath(std::string_view object_path)
+        : m_object_path(validate(object_path))
+    {}
+
+    ObjectPath(const std::string &object_path)
+        : ObjectPath(std::string_view(object_path))
+    {}
+
+    ObjectPath(const char *object_path)
+        : ObjectPath(std::string_view(object_path))
+    {}
+
+    const char *c_str() const noexcept
+    {
+        return m_object_path.c_str();
+    }
+
+    std::string_view as_string_view() const noexcept
+    {
+        return m_object_path.view();
+    }
+
+    /* Returns a copy since the object path isn't stored in a std::string anymore, so the pointer
+     * of as_string().c_str() doesn't outlive the statement, use c_str() or as_string_view() */
+    [[deprecated("returns a copy, use c_str() or as_string_view()")]]
+    std::string as_string() const
+    {
+        return std::string(as_string_view());
+    }
+
+    friend bool operator==(const ObjectPath &lhs, const ObjectPath &rhs) noexcept
+    {
+        return lhs.as_string_view() == rhs.as_string_view();
+    }
+
+    friend std::strong_ordering operator<=>(const ObjectPath &lhs, const ObjectPath &rhs) noexcept
+    {
+        return lhs.as_string_view() <=> rhs.as_string_view();
+    }
+
+private:
+    template<typename T>
+    friend struct Details::DBusDeserializer;
+
+    /* Object paths of messages are already validated by GLib */
+    explicit ObjectPath(Details::SmallString object_path) noexcept
+        : m_object_path(std::move(object_path))
+    {}
+
+    static std::string_view validate(std::string_view object_path)
+    {
+        if (!Details::dbus_is_object_path(object_path)) {
+            GIO_DBUS_CPP_THROW_ERROR(
+                "Attempt to create Gio::DBus::ObjectPath using not valid object path \""
+                + std::string(object_path) + "\"")
+        }
 
+        return object_path;
+    }
+
+    Details::SmallString m_object_path;
+};
+
+/* Non-owning view of a valid, nul-terminated object path, either borrowed from a
+ * Gio::DBus::ObjectPath or from the serialized data of a message. */
+class ObjectPathView
+{
 public:
-    ObjectPath(std::string object_path);
+    ObjectPathView(const ObjectPath &object_path) noexcept
+        : m_object_path(object_path.as_string_view())
+    {}
+
+    /* A view of a temporary would dangle once the statement ends */
+    ObjectPathView(ObjectPath &&) = delete;
+
+    std::string_view as_string_view() const noexcept
+    {
+        return m_object_path;
+    }
+
+private:
+    template<typename T>
+    friend struct Details::DBusDeserializer;
+
+    ObjectPathView(std::string_view object_path) noexcept
+        : m_object_path(object_path)
+    {}
 
-    const std::string &as_string() const noexcept;
+    std::string_view m_object_path;
 };
 
+namespace Literals {
+
+/* "/org/freedesktop/DBus"_path, the object path is validated at compile time and created once */
+template<Details::CompileTimeString S>
+ObjectPath operator""_path()
+{
+    static_assert(Details::dbus_is_object_path(S.data()),
+                  "Attempt to create Gio::DBus::ObjectPath using not valid object path literal");
+
+    static const ObjectPath object_path(std::string_view(S.data()));
+    return object_path;
+}
+
+} /* namespace Literals */
+
 } /* namespace Gio::DBus */
 
+template<>
+struct std::hash<Gio::DBus::ObjectPath>
+{
+    size_t operator()(const Gio::DBus::ObjectPath &object_path) const noexcept
+    {
+        return std::hash<std::string_view>()(object_path.as_string_view());
+    }
+};
+
 #endif /* GIO_DBUS_CPP_OBJECT_PATH_HPP */
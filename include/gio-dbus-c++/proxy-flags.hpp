@@ -0,0 +1,44 @@
+#ifndef GIO_DBUS_CPP_PROXY_FLAGS_HPP
+#define GIO_DBUS_CPP_PROXY_FLAGS_HPP
+
+namespace Gio::DBus {
+
+/* Controls what creating a proxy costs. Signals are never connected at creation, a proxy adds its
+ * match rule on the first Proxy::subscribe_to_signal() */
+enum class ProxyFlags : unsigned int {
+    None = 0,
+
+    /* Skips the GetAll round trip loading the properties, which the proxy doesn't read */
+    DoNotLoadProperties = 1 << 0,
+
+    /* Neither creating the proxy nor calling its methods activates the service */
+    DoNotAutoStart = 1 << 1,
+
+    /* Creating the proxy doesn't activate the service, calling its methods still does */
+    DoNotAutoStartAtConstruction = 1 << 2,
+
+    /* Defers creating the underlying proxy until its first use. Synchronous calls block while it
+     * is created and throw Gio::DBus::Error if it can't be, asynchronous calls and signal
+     * subscriptions create it in the background, the calls wait for it and report a failed
+     * creation through their error callback, signals are received once it is created */
+    Lazy = 1 << 3,
+};
+
+constexpr ProxyFlags operator|(ProxyFlags lhs, ProxyFlags rhs) noexcept
+{
+    return static_cast<ProxyFlags>(static_cast<unsigned int>(lhs) | static_cast<unsigned int>(rhs));
+}
+
+constexpr ProxyFlags operator&(ProxyFlags lhs, ProxyFlags rhs) noexcept
+{
+    return static_cast<ProxyFlags>(static_cast<unsigned int>(lhs) & static_cast<unsigned int>(rhs));
+}
+
+constexpr bool has_flag(ProxyFlags flags, ProxyFlags flag) noexcept
+{
+    return (flags & flag) == flag;
+}
+
+} /* namespace Gio::DBus */
+
+#endif /* GIO_DBUS_CPP_PROXY_FLAGS_HPP */
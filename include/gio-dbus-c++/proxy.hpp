@@ -2,11 +2,14 @@
 #define GIO_DBUS_CPP_PROXY_HPP
 
 #include "common.hpp"
+#include "decode-limits.hpp"
 #include "error.hpp"
 #include "message.hpp"
+#include "proxy-flags.hpp"
 #include "subscription.hpp"
 #include "timeout.hpp"
 
+#include "details/dbus-type-traits.hpp"
 #include "details/pimpl.hpp"
 
 #include <functional>
@@ -22,17 +25,51 @@ class GIO_DBUS_CPP_EXPORT_CLASS(Proxy)
     GIO_DBUS_CPP_DECLARE_PIMPL_PARTS(Proxy, ProxyImpl)
 
 public:
-    Proxy(Connection &connection, std::string service, std::string object, std::string interface);
+    Proxy(Connection &connection,
+          std::string service,
+          std::string object,
+          std::string interface,
+          ProxyFlags flags = ProxyFlags::None);
+
+    /* Creates the proxy without blocking the calling thread, the callbacks are called from its
+     * thread default main context. The proxy is created right away, so ProxyFlags::Lazy is
+     * ignored and not reported by flags() */
+    static void create_async(Connection &connection,
+                             std::string service,
+                             std::string object,
+                             std::string interface,
+                             std::function<void(Proxy)> on_success,
+                             std::function<void(const Error &)> on_error,
+                             ProxyFlags flags = ProxyFlags::None);
 
     const std::string &service() const noexcept;
     const std::string &object() const noexcept;
     const std::string &interface() const noexcept;
+    ProxyFlags flags() const noexcept;
+
+    /* Limits applied to the replies and signals received through the proxy, replies exceeding
+     * them fail with Gio::DBus::Error when read, see Gio::DBus::DecodeLimits */
+    void set_decode_limits(const DecodeLimits &limits) noexcept;
+    const DecodeLimits &decode_limits() const noexcept;
 
     Message call(const std::string &method, const Timeout &timeout = Timeout::Default) const;
     Message call(const std::string &method,
                  const Message &arguments,
                  const Timeout &timeout = Timeout::Default) const;
 
+    /* Passes each value as a separate argument without copying it, a single value keeps the
+     * meaning of call(method, Message(value)) so a std::tuple still expands to arguments */
+    template<typename... Args>
+        requires(sizeof...(Args) > 0 && (Details::is_dbus_type_v<Args> && ...))
+    Message call(const std::string &method, const Args &...arguments) const
+    {
+        if constexpr (sizeof...(Args) == 1) {
+            return call(method, Message(arguments...));
+        } else {
+            return call(method, Message::from(arguments...));
+        }
+    }
+
     void call_async(const std::string &method,
                     const std::function<void(const Message &)> &on_success,
                     const std::function<void(const Error &)> &on_error,
@@ -43,9 +80,16 @@ public:
                     const std::function<void(const Error &)> &on_error,
                     const Timeout &timeout = Timeout::Default) const;
 
+    /* Handlers are called from the thread default main context of the first subscription of
+     * the proxy, which adds its match rule, and only for signals sent by the current owner of
+     * the service name */
     Subscription subscribe_to_signal(std::string signal_name,
                                      std::function<void(const Message &)> on_signal_emitted) const;
     void unsubscribe_from_signal(const Subscription &subscription) const;
+
+private:
+    friend class ProxyImpl;
+    explicit Proxy(std::unique_ptr<ProxyImpl> pimpl) noexcept;
 };
 
 } /* namespace Gio::DBus */
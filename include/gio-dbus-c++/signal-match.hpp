@@ -0,0 +1,36 @@
+#ifndef GIO_DBUS_CPP_SIGNAL_MATCH_HPP
+#define GIO_DBUS_CPP_SIGNAL_MATCH_HPP
+
+#include <map>
+#include <string>
+
+namespace Gio::DBus {
+
+/* Signals to receive through Connection::subscribe_to_signal, empty fields match anything. The
+ * match is installed on the bus as a match rule, so the bus daemon drops signals not matching
+ * it before they are sent to the process. */
+struct SignalMatch
+{
+    /* Before GLib 2.80.1 signals matched on a well-known name are delivered from any sender,
+     * not only from the owner of the name, match on its unique name where that matters */
+    std::string sender;
+    std::string interface;
+    std::string member;
+
+    /* Matches signals of this object only, can't be combined with object_namespace */
+    std::string object;
+
+    /* Matches signals of this object and of all objects below it (path_namespace) */
+    std::string object_namespace;
+
+    /* Matches string arguments by index, from arg0 to arg63 */
+    std::map<unsigned int, std::string> args;
+
+    /* Matches the first argument as a bus name or any name below it, e.g. "org.example" matches
+     * "org.example" and "org.example.Service" (arg0namespace), can't be combined with args[0] */
+    std::string arg0_namespace;
+};
+
+} /* namespace Gio::DBus */
+
+#endif /* GIO_DBUS_CPP_SIGNAL_MATCH_HPP */
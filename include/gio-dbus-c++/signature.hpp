@@ -1,25 +1,216 @@
 #ifndef GIO_DBUS_CPP_SIGNATURE_HPP
 #define GIO_DBUS_CPP_SIGNATURE_HPP
 
-#include "common.hpp"
-
-#include "details/pimpl.hpp"
+#include "details/compile-time-string.hpp"
+#include "details/dbus-signature-table.hpp"
+#include "details/dbus-validation.hpp"
+#include "details/exception.hpp"
+#include "details/small-string.hpp"
 
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <gio/gio.h>
 #include <string>
+#include <string_view>
 
 namespace Gio::DBus {
 
-class SignatureImpl;
-class GIO_DBUS_CPP_EXPORT_CLASS(Signature)
+namespace Details {
+
+template<typename T>
+struct DBusDeserializer;
+
+} /* namespace Details */
+
+/* Valid signature stored inline up to Details::SmallString::InlineCapacity characters, or
+ * interned in the process-wide table when it is used again and again, e.g. signatures of
+ * compile time types and "..."_sig literals. Comparing interned signatures compares their
+ * addresses. Default constructed signature is the empty one. */
+class Signature
 {
-    GIO_DBUS_CPP_DECLARE_PIMPL_PARTS(Signature, SignatureImpl)
+public:
+    Signature()
+        : m_signature("")
+    {}
+
+    Signature(std::string_view signature)
+        : m_signature(validate(signature))
+    {}
+
+    Signature(const std::string &signature)
+        : Signature(std::string_view(signature))
+    {}
+
+    Signature(const char *signature)
+        : Signature(std::string_view(signature))
+    {}
+
+    /* Validates and interns the signature, interned signatures are never released, so only
+     * signatures known to the process are interned, e.g. from introspection data, never the
+     * ones received from peers */
+    static Signature intern(std::string_view signature)
+    {
+        const Details::DBusInternedSignature *interned = Details::DBusSignatureTable::intern(
+            signature);
+
+        if (!interned) {
+            GIO_DBUS_CPP_THROW_ERROR(
+                "Attempt to create Gio::DBus::Signature using not valid signature \""
+                + std::string(signature) + "\"")
+        }
+
+        return Signature(interned);
+    }
+
+    const char *c_str() const noexcept
+    {
+        return m_interned ? m_interned->signature.c_str() : m_signature.c_str();
+    }
+
+    std::string_view as_string_view() const noexcept
+    {
+        return m_interned ? std::string_view(m_interned->signature) : m_signature.view();
+    }
+
+    /* Returns a copy since the signature isn't stored in a std::string anymore, so the pointer
+     * of as_string().c_str() doesn't outlive the statement, use c_str() or as_string_view() */
+    [[deprecated("returns a copy, use c_str() or as_string_view()")]]
+    std::string as_string() const
+    {
+        return std::string(as_string_view());
+    }
+
+    friend bool operator==(const Signature &lhs, const Signature &rhs) noexcept
+    {
+        if (lhs.m_interned && rhs.m_interned) {
+            return lhs.m_interned == rhs.m_interned;
+        }
+
+        return lhs.as_string_view() == rhs.as_string_view();
+    }
+
+    friend std::strong_ordering operator<=>(const Signature &lhs, const Signature &rhs) noexcept
+    {
+        if (lhs.m_interned && lhs.m_interned == rhs.m_interned) {
+            return std::strong_ordering::equal;
+        }
+
+        return lhs.as_string_view() <=> rhs.as_string_view();
+    }
+
+private:
+    friend class Message;
+    friend class Variant;
+    friend struct std::hash<Signature>;
+
+    template<typename T>
+    friend struct Details::DBusDeserializer;
+
+    explicit Signature(const Details::DBusInternedSignature *signature) noexcept
+        : m_interned(signature)
+    {}
+
+    /* Signatures of messages are already validated by GLib */
+    explicit Signature(Details::SmallString signature) noexcept
+        : m_signature(std::move(signature))
+    {}
+
+    static std::string_view validate(std::string_view signature)
+    {
+        if (!Details::dbus_is_signature(signature)) {
+            GIO_DBUS_CPP_THROW_ERROR(
+                "Attempt to create Gio::DBus::Signature using not valid signature \""
+                + std::string(signature) + "\"")
+        }
 
+        return signature;
+    }
+
+    /* Whether the type of the value is the single complete type of the signature */
+    bool is_type_of(GVariant *value) const noexcept
+    {
+        if (m_interned) {
+            return Details::dbus_is_of_signature(value, m_interned);
+        }
+
+        return as_string_view() == g_variant_get_type_string(value);
+    }
+
+    /* Whether the value is a tuple of the values of the signature, e.g. the body of a message */
+    bool is_tuple_type_of(GVariant *value) const noexcept
+    {
+        if (m_interned) {
+            return Details::dbus_is_of_tuple_signature(value, m_interned);
+        }
+
+        const std::string_view type = g_variant_get_type_string(value);
+        const std::string_view signature = as_string_view();
+
+        return type.size() == signature.size() + 2 && type.front() == '('
+               && type.back() == ')' && type.substr(1, signature.size()) == signature;
+    }
+
+    const Details::DBusInternedSignature *m_interned = nullptr;
+    Details::SmallString m_signature;
+};
+
+/* Non-owning view of a valid, nul-terminated signature, either borrowed from a
+ * Gio::DBus::Signature or from the serialized data of a message. */
+class SignatureView
+{
 public:
-    Signature(std::string signature);
+    SignatureView(const Signature &signature) noexcept
+        : m_signature(signature.as_string_view())
+    {}
+
+    /* A view of a temporary would dangle once the statement ends */
+    SignatureView(Signature &&) = delete;
+
+    std::string_view as_string_view() const noexcept
+    {
+        return m_signature;
+    }
 
-    const std::string &as_string() const noexcept;
+private:
+    template<typename T>
+    friend struct Details::DBusDeserializer;
+
+    SignatureView(std::string_view signature) noexcept
+        : m_signature(signature)
+    {}
+
+    std::string_view m_signature;
 };
 
+namespace Literals {
+
+/* "a{sv}"_sig, the signature is validated at compile time and interned once */
+template<Details::CompileTimeString S>
+Signature operator""_sig()
+{
+    static_assert(Details::dbus_is_signature(S.data()),
+                  "Attempt to create Gio::DBus::Signature using not valid signature literal");
+
+    static const Signature signature = Signature::intern(S.data());
+    return signature;
+}
+
+} /* namespace Literals */
+
 } /* namespace Gio::DBus */
 
+template<>
+struct std::hash<Gio::DBus::Signature>
+{
+    size_t operator()(const Gio::DBus::Signature &signature) const noexcept
+    {
+        if (signature.m_interned) {
+            return signature.m_interned->hash;
+        }
+
+        return std::hash<std::string_view>()(signature.as_string_view());
+    }
+};
+
 #endif /* GIO_DBUS_CPP_SIGNATURE_HPP */
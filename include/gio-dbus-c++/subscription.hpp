@@ -1,24 +1,39 @@
 #ifndef GIO_DBUS_CPP_SUBSCRIPTION_HPP
 #define GIO_DBUS_CPP_SUBSCRIPTION_HPP
 
-#include "common.hpp"
-
-#include "details/pimpl.hpp"
+#include <cstddef>
+#include <cstdint>
 
 namespace Gio::DBus {
 
-class SubscriptionImpl;
-class GIO_DBUS_CPP_EXPORT_CLASS(Subscription)
+/* Identifies a signal handler of a proxy or of a connection, default constructed subscription
+ * identifies none */
+class Subscription
 {
-    GIO_DBUS_CPP_DECLARE_PIMPL_PARTS(Subscription, SubscriptionImpl)
-
 public:
-    uintptr_t proxy_id() const noexcept;
-    size_t id() const noexcept;
+    Subscription() noexcept = default;
+
+    uintptr_t proxy_id() const noexcept
+    {
+        return m_proxy_id;
+    }
+
+    size_t id() const noexcept
+    {
+        return m_id;
+    }
 
 private:
+    friend class ConnectionImpl;
     friend class ProxyImpl;
-    Subscription(uintptr_t proxy_id, size_t id);
+
+    Subscription(uintptr_t proxy_id, size_t id) noexcept
+        : m_proxy_id(proxy_id)
+        , m_id(id)
+    {}
+
+    uintptr_t m_proxy_id = 0;
+    size_t m_id = 0;
 };
 
 } /* namespace Gio::DBus */
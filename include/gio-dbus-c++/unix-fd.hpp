@@ -1,21 +1,27 @@
 #ifndef GIO_DBUS_CPP_UNIX_FD_HPP
 #define GIO_DBUS_CPP_UNIX_FD_HPP
 
-#include "common.hpp"
-
-#include "details/pimpl.hpp"
-
 namespace Gio::DBus {
 
-class UnixFDImpl;
-class GIO_DBUS_CPP_EXPORT_CLASS(UnixFD)
+/* Index of a file descriptor passed along with a message, default constructed one is -1 */
+class UnixFD
 {
-    GIO_DBUS_CPP_DECLARE_PIMPL_PARTS(UnixFD, UnixFDImpl)
-
 public:
-    UnixFD(int unix_fd);
+    constexpr UnixFD() noexcept = default;
+
+    constexpr UnixFD(int unix_fd) noexcept
+        : m_unix_fd(unix_fd)
+    {}
+
+    constexpr int as_int() const noexcept
+    {
+        return m_unix_fd;
+    }
+
+    friend constexpr bool operator==(UnixFD lhs, UnixFD rhs) noexcept = default;
 
-    int as_int() const noexcept;
+private:
+    int m_unix_fd = -1;
 };
 
 } /* namespace Gio::DBus */
@@ -1,13 +1,25 @@
 #ifndef GIO_DBUS_CPP_VARIANT_HPP
 #define GIO_DBUS_CPP_VARIANT_HPP
 
+#include "decode-limits.hpp"
+#include "details/dbus-decode-limits.hpp"
 #include "details/dbus-deserializer.hpp"
+#include "details/dbus-dictionary.hpp"
+#include "details/dbus-encoder.hpp"
 #include "details/dbus-serializer.hpp"
+#include "details/dbus-signature-table.hpp"
 #include "details/dbus-type-traits.hpp"
 #include "details/exception.hpp"
 
+#include <cstring>
 #include <gio/gio.h>
 #include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <variant>
+#include <vector>
 
 namespace Gio::DBus {
 
@@ -17,12 +29,19 @@ public:
     template<typename T>
     Variant(const T &value);
 
+    /* A large string or buffer of trivial types is handed over to the variant instead of being
+     * copied, other values are encoded as by Variant(const T &) */
+    template<typename T>
+        requires(!std::is_lvalue_reference_v<T> && !std::is_const_v<std::remove_reference_t<T>>
+                 && Details::is_dbus_type_v<T>)
+    Variant(T &&value);
+
     Variant(GVariant *variant)
         : m_variant(gio_variant_to_owned(variant), &g_variant_unref)
     {}
 
     template<typename T>
-    bool contains_value_of_type() const noexcept
+    bool contains_value_of_type() const
     {
         using namespace Details;
 
@@ -30,16 +49,98 @@ public:
                       "Attempt to check whether Gio::DBus::Variant stores a value of type T using "
                       "Gio::DBus::Variant::is<T>(), but T is not a dbus type");
 
-        return g_variant_is_of_type(as_gio_variant(), dbus_type_to_variant_type_v<T>);
+        return dbus_is_of_type<T>(as_gio_variant());
+    }
+
+    bool contains_value_of_signature(const Signature &signature) const noexcept
+    {
+        return signature.is_type_of(as_gio_variant());
+    }
+
+    /* Type of the value stored in the variant */
+    Signature signature() const
+    {
+        return Signature(Details::SmallString(dbus_type_signature()));
     }
 
     template<typename T>
     T as() const;
 
+    /* Reads a value without checking the type of the variant first, for variants known to
+     * contain T. Debug builds still check the type. */
+    template<typename T>
+    T as_unchecked() const;
+
+    /* Reads a value within the limits instead of the ones of the variant, see
+     * Gio::DBus::DecodeLimits */
+    template<typename T>
+    T as(const DecodeLimits &limits) const;
+
+    /* Reads a value whose strings and containers, including nested ones, use std::pmr
+     * allocators and allocates all of them from the memory resource */
+    template<typename T>
+    T as(std::pmr::memory_resource *resource) const;
+
+    /* Reads a value into an existing one, containers and strings are refilled in place and
+     * reuse the memory they already own */
+    template<typename T>
+    void as_into(T &value) const;
+
+    /* Reads a value that may contain views (std::span<const T> and friends) pointing into the
+     * serialized data of the variant. The views stay valid as long as the variant is alive. The
+     * first view keeps the members of a structure alive in the variant, so it is not taken from
+     * several threads at once. */
+    template<typename T>
+    T view() const &;
+
+    template<typename T>
+    T view() const && = delete;
+
+    /* Decodes the value as the alternative of std::variant<T...> of the same type and calls
+     * the visitor with it, the type of the value is matched once through a table indexed by
+     * its first character instead of probing contains_value_of_type<T>() type after type */
+    template<typename... T, typename Visitor>
+    decltype(auto) visit(Visitor &&visitor) const &;
+
+    /* Alternatives viewing the serialized data would dangle once a temporary variant is gone */
+    template<typename... T, typename Visitor>
+        requires(Details::is_dbus_view_type_v<T> || ...)
+    decltype(auto) visit(Visitor &&visitor) const && = delete;
+
+    /* Looks up a key in the dictionary with string keys stored in the variant and decodes only
+     * the value found, values of a{sv} are unwrapped unless V is Gio::DBus::Variant */
+    template<typename V>
+    std::optional<V> lookup(std::string_view key) const;
+
+    /* Looks up several keys during a single pass over the dictionary */
+    template<typename... V>
+    std::tuple<std::optional<V>...> lookup_many(Details::DBusDictionaryKey<V>... keys) const;
+
+    /* Limits applied to every read of the variant, variants decoded as a part of a message or
+     * of another variant keep the limits left to it at that point */
+    void set_decode_limits(const DecodeLimits &limits) noexcept
+    {
+        m_decode_limits = limits;
+    }
+
+    const DecodeLimits &decode_limits() const noexcept
+    {
+        return m_decode_limits;
+    }
+
 private:
+    template<typename T, typename Read>
+    decltype(auto) read(const char *method, const Read &reader, const DecodeLimits &limits) const;
+
     template<typename T>
     friend struct Details::DBusSerializer;
 
+    template<typename T>
+    friend struct Details::DBusDeserializer;
+
+    template<typename T>
+    friend struct Details::DBusEncoder;
+
     const char *dbus_type_signature() const noexcept
     {
         const char *type_signature = g_variant_get_type_string(m_variant.get());
@@ -58,14 +159,26 @@ private:
 
     GVariant *gio_variant_to_owned(GVariant *variant)
     {
-        if (g_variant_is_floating(variant)) {
-            return variant;
+        return g_variant_ref_sink(variant);
+    }
+
+    /* Members of a structure are kept alive as the arguments of a message are, other values are
+     * serialized, which GDBus has already done for strings and fixed arrays */
+    void keep_viewed_data() const
+    {
+        GVariant *value = as_gio_variant();
+
+        if (g_variant_is_of_type(value, G_VARIANT_TYPE_TUPLE)
+            || g_variant_is_of_type(value, G_VARIANT_TYPE_DICT_ENTRY)) {
+            Details::dbus_pin_children(value, m_viewed_children);
         } else {
-            return g_variant_ref(variant);
+            g_variant_get_data(value);
         }
     }
 
     std::unique_ptr<GVariant, decltype(&g_variant_unref)> m_variant;
+    DecodeLimits m_decode_limits;
+    mutable std::vector<Details::GVariantUniquePtr> m_viewed_children;
 };
 
 namespace Details {
@@ -86,12 +199,46 @@ struct DBusSerializer<Gio::DBus::Variant>
     }
 };
 
+template<>
+struct DBusEncoder<Gio::DBus::Variant>
+{
+    /* The serialized variant is the serialized child followed by a nul byte and its type */
+    static size_t size(const Gio::DBus::Variant &variant) noexcept
+    {
+        GVariant *child = variant.as_gio_variant();
+        return g_variant_get_size(child) + 1 + std::strlen(g_variant_get_type_string(child));
+    }
+
+    static size_t encode(const Gio::DBus::Variant &variant, char *data) noexcept
+    {
+        GVariant *child = variant.as_gio_variant();
+
+        const size_t size = g_variant_get_size(child);
+        const char *type = g_variant_get_type_string(child);
+        const size_t type_size = std::strlen(type);
+
+        if (size) {
+            std::memcpy(data, g_variant_get_data(child), size);
+        }
+
+        data[size] = '\0';
+        std::memcpy(data + size + 1, type, type_size);
+
+        return size + 1 + type_size;
+    }
+};
+
 template<>
 struct DBusDeserializer<Gio::DBus::Variant>
 {
     static Gio::DBus::Variant deserialize(GVariant *message)
     {
-        return g_variant_get_variant(message);
+        GVariantUniquePtr child(g_variant_get_variant(message), &g_variant_unref);
+
+        Gio::DBus::Variant variant(child.get());
+        variant.m_decode_limits = dbus_decode_remaining_limits();
+
+        return variant;
     }
 };
 
@@ -103,12 +250,12 @@ Variant::Variant(const T &value)
 {
     using namespace Details;
 
-    static_assert(is_dbus_type_v<T>(),
+    static_assert(is_dbus_type_v<T>,
                   "Attempt to construct Gio::DBus::Variant from value of type T using "
                   "Gio::DBus::Variant::Variant<T>(const T &), but T is not a dbus type");
 
     try {
-        m_variant.reset(gio_variant_to_owned(DBusSerializer<T>::serialize(value)));
+        m_variant.reset(gio_variant_to_owned(dbus_encode(value)));
     }
     catch (const std::exception &error) {
         GIO_DBUS_CPP_THROW_ERROR(
@@ -118,6 +265,33 @@ Variant::Variant(const T &value)
     }
 }
 
+template<typename T>
+    requires(!std::is_lvalue_reference_v<T> && !std::is_const_v<std::remove_reference_t<T>>
+             && Details::is_dbus_type_v<T>)
+Variant::Variant(T &&value)
+    : m_variant(nullptr, &g_variant_unref)
+{
+    using namespace Details;
+
+    try {
+        if constexpr (is_dbus_movable_type_v<T>) {
+            if (dbus_is_worth_moving(value)) {
+                m_variant.reset(
+                    gio_variant_to_owned(DBusSerializer<T>::serialize(std::move(value))));
+                return;
+            }
+        }
+
+        m_variant.reset(gio_variant_to_owned(dbus_encode(value)));
+    }
+    catch (const std::exception &error) {
+        GIO_DBUS_CPP_THROW_ERROR(
+            std::string("Failed to construct Gio::DBus::Variant from value of type T (aka ")
+            + DBusType<T>::class_name.data() + " aka " + DBusType<T>::name.data()
+            + ") using Gio::DBus::Variant::Variant<T>(T &&)" + " (" + error.what() + ")");
+    }
+}
+
 template<typename T>
 T Variant::as() const
 {
@@ -127,23 +301,162 @@ T Variant::as() const
                   "Attempt to read a value of type T using Gio::DBus::Variant::as<T>(), "
                   "but T is not a dbus type");
 
+    static_assert(!is_dbus_view_type_v<T>,
+                  "Attempt to read a value of type T using Gio::DBus::Variant::as<T>(), "
+                  "but T borrows from the variant, use Gio::DBus::Variant::view<T>()");
+
+    return read<T>("as", &DBusDeserializer<T>::deserialize, m_decode_limits);
+}
+
+template<typename T>
+T Variant::as_unchecked() const
+{
+    using namespace Details;
+
+    static_assert(is_dbus_type_v<T>,
+                  "Attempt to read a value of type T using Gio::DBus::Variant::as_unchecked<T>(), "
+                  "but T is not a dbus type");
+
+    static_assert(!is_dbus_view_type_v<T>,
+                  "Attempt to read a value of type T using Gio::DBus::Variant::as_unchecked<T>(), "
+                  "but T borrows from the variant, use Gio::DBus::Variant::view<T>()");
+
+#ifdef NDEBUG
+    const DBusDecodeScope scope(m_decode_limits);
+    return DBusDeserializer<T>::deserialize(as_gio_variant());
+#else
+    return read<T>("as_unchecked", &DBusDeserializer<T>::deserialize, m_decode_limits);
+#endif
+}
+
+template<typename T>
+T Variant::as(const DecodeLimits &limits) const
+{
+    using namespace Details;
+
+    static_assert(is_dbus_type_v<T>,
+                  "Attempt to read a value of type T using Gio::DBus::Variant::as<T>(limits), "
+                  "but T is not a dbus type");
+
+    static_assert(!is_dbus_view_type_v<T>,
+                  "Attempt to read a value of type T using Gio::DBus::Variant::as<T>(limits), "
+                  "but T borrows from the variant, use Gio::DBus::Variant::view<T>()");
+
+    return read<T>("as", &DBusDeserializer<T>::deserialize, limits);
+}
+
+template<typename T>
+T Variant::as(std::pmr::memory_resource *resource) const
+{
+    static_assert(std::is_default_constructible_v<T>,
+                  "Attempt to read a value of type T using "
+                  "Gio::DBus::Variant::as<T>(resource), but T is not default constructible");
+
+    T value = std::make_obj_using_allocator<T>(std::pmr::polymorphic_allocator<>(resource));
+    as_into(value);
+
+    return value;
+}
+
+template<typename T>
+void Variant::as_into(T &value) const
+{
+    using namespace Details;
+
+    static_assert(is_dbus_type_v<T>,
+                  "Attempt to read a value of type T using Gio::DBus::Variant::as_into<T>(), "
+                  "but T is not a dbus type");
+
+    static_assert(!is_dbus_view_type_v<T>,
+                  "Attempt to read a value of type T using Gio::DBus::Variant::as_into<T>(), "
+                  "but T borrows from the variant, use Gio::DBus::Variant::view<T>()");
+
+    read<T>(
+        "as_into",
+        [&value](GVariant *variant) {
+            dbus_deserialize_into(variant, value);
+        },
+        m_decode_limits);
+}
+
+template<typename... T, typename Visitor>
+decltype(auto) Variant::visit(Visitor &&visitor) const &
+{
+    using namespace Details;
+
+    static_assert(sizeof...(T) > 0,
+                  "Attempt to visit Gio::DBus::Variant using "
+                  "Gio::DBus::Variant::visit<T...>(visitor) without alternatives");
+
+    static_assert((is_dbus_type_v<T> && ...),
+                  "Attempt to visit Gio::DBus::Variant using "
+                  "Gio::DBus::Variant::visit<T...>(visitor), but T is not a dbus type");
+
+    /* Alternatives may borrow from the variant, see Gio::DBus::Variant::view<T>() */
+    if constexpr ((is_dbus_view_type_v<T> || ...)) {
+        keep_viewed_data();
+    }
+
+    auto value = [this] {
+        const DBusDecodeScope scope(m_decode_limits);
+        return DBusDeserializer<std::variant<T...>>::deserialize_value(as_gio_variant());
+    }();
+
+    return std::visit(std::forward<Visitor>(visitor), std::move(value));
+}
+
+template<typename V>
+std::optional<V> Variant::lookup(std::string_view key) const
+{
+    return std::get<0>(lookup_many<V>(key));
+}
+
+template<typename... V>
+std::tuple<std::optional<V>...> Variant::lookup_many(Details::DBusDictionaryKey<V>... keys) const
+{
+    const Details::DBusDecodeScope scope(m_decode_limits);
+    return Details::dbus_dictionary_lookup<V...>(as_gio_variant(), {keys...});
+}
+
+template<typename T>
+T Variant::view() const &
+{
+    using namespace Details;
+
+    static_assert(is_dbus_type_v<T>,
+                  "Attempt to read a value of type T using Gio::DBus::Variant::view<T>(), "
+                  "but T is not a dbus type");
+
+    keep_viewed_data();
+
+    return read<T>("view", &DBusDeserializer<T>::deserialize, m_decode_limits);
+}
+
+template<typename T, typename Read>
+decltype(auto) Variant::read(const char *method,
+                             const Read &reader,
+                             const DecodeLimits &limits) const
+{
+    using namespace Details;
+
     if (!contains_value_of_type<T>()) {
         GIO_DBUS_CPP_THROW_ERROR(std::string("Attempt to read a value of type T (aka ")
                                  + DBusType<T>::class_name.data() + " aka "
-                                 + DBusType<T>::name.data()
-                                 + ") using Gio::DBus::Variant::as<T>(), "
-                                   "but Gio::DBus::Variant contains value of type "
+                                 + DBusType<T>::name.data() + ") using Gio::DBus::Variant::"
+                                 + method + "<T>(), "
+                                 + "but Gio::DBus::Variant contains value of type "
                                  + dbus_type_signature());
     }
 
     try {
-        return DBusDeserializer<T>::deserialize(as_gio_variant());
+        const DBusDecodeScope scope(limits);
+        return reader(as_gio_variant());
     }
     catch (const std::exception &err) {
         GIO_DBUS_CPP_THROW_ERROR(std::string("Failed to read a value of type T (aka ")
                                  + DBusType<T>::class_name.data() + " aka "
-                                 + DBusType<T>::name.data()
-                                 + ") using Gio::DBus::Variant::as<T>() (" + err.what() + ")");
+                                 + DBusType<T>::name.data() + ") using Gio::DBus::Variant::"
+                                 + method + "<T>() (" + err.what() + ")");
     }
 }
 
@@ -1,7 +1,10 @@
 #include "connection.hpp"
 #include "error.hpp"
+#include "method-call.hpp"
+#include "signal-registry.hpp"
 
 #include <gio/gio.h>
+#include <unordered_set>
 
 namespace {
 
@@ -36,8 +39,45 @@ public:
     const std::string &unique_name() const noexcept;
     const std::string &name() const noexcept;
 
+    void set_trusted_peer(bool trusted);
+    bool is_trusted_peer() const noexcept;
+
     GDBusConnection *as_gio_connection() const;
 
+    Subscription subscribe_to_signal(const SignalMatch &match,
+                                     std::function<void(const Message &)> on_signal_emitted);
+    void unsubscribe_from_signal(const Subscription &subscription) noexcept;
+
+    Message call(const std::string &service,
+                 const std::string &object,
+                 const std::string &interface,
+                 const std::string &method,
+                 const Message &arguments,
+                 const Timeout &timeout) const;
+    Message call(const std::string &service,
+                 const std::string &object,
+                 const std::string &interface,
+                 const std::string &method,
+                 GVariant *arguments,
+                 const Timeout &timeout) const;
+
+    void call_async(const std::string &service,
+                    const std::string &object,
+                    const std::string &interface,
+                    const std::string &method,
+                    const Message &arguments,
+                    const std::function<void(const Message &)> &on_success,
+                    const std::function<void(const Error &)> &on_error,
+                    const Timeout &timeout) const;
+    void call_async(const std::string &service,
+                    const std::string &object,
+                    const std::string &interface,
+                    const std::string &method,
+                    GVariant *arguments,
+                    const std::function<void(const Message &)> &on_success,
+                    const std::function<void(const Error &)> &on_error,
+                    const Timeout &timeout) const;
+
 private:
     void setup_unique_name_with_connection(GDBusConnection *connection);
 
@@ -49,6 +89,8 @@ private:
     unsigned int m_name_acquire_id;
     std::function<void(const std::string &)> m_on_name_acquired;
     std::function<void(const std::string &)> m_on_name_lost;
+    bool m_trusted_peer = false;
+    std::unordered_set<size_t> m_signal_subscriptions;
     std::unique_ptr<GDBusConnection, decltype(&g_object_unref)> m_connection;
 };
 
@@ -92,11 +134,21 @@ ConnectionImpl::ConnectionImpl(const std::string &address)
                                  + " address " + "(" + error->message + ")");
     }
 
+    /* Peer-to-peer connections have no bus assigning them a unique name */
+    if (!g_dbus_connection_get_unique_name(connection)) {
+        m_connection.reset(connection);
+        return;
+    }
+
     setup_unique_name_with_connection(connection);
 }
 
 ConnectionImpl::~ConnectionImpl()
 {
+    for (size_t id: m_signal_subscriptions) {
+        SignalRegistry::of(m_connection.get()).unsubscribe(id);
+    }
+
     if (m_name_acquire_id) {
         g_bus_unown_name(m_name_acquire_id);
 
@@ -169,11 +221,161 @@ const std::string &ConnectionImpl::name() const noexcept
     return m_name;
 }
 
+/* Only the peer of a peer-to-peer connection can be trusted, the bus connections are shared by
+ * the whole process and deliver messages of every other process on the bus */
+void ConnectionImpl::set_trusted_peer(bool trusted)
+{
+    if (trusted && !m_unique_name.empty()) {
+        GIO_DBUS_CPP_THROW_ERROR("Failed to trust the peer of " + m_unique_name
+                                 + " dbus connection (only peer-to-peer connections can be "
+                                   "trusted)");
+    }
+
+    m_trusted_peer = trusted;
+}
+
+bool ConnectionImpl::is_trusted_peer() const noexcept
+{
+    return m_trusted_peer;
+}
+
 GDBusConnection *ConnectionImpl::as_gio_connection() const
 {
     return m_connection.get();
 }
 
+Subscription ConnectionImpl::subscribe_to_signal(
+    const SignalMatch &match, std::function<void(const Message &)> on_signal_emitted)
+{
+    /* The subscription is removed in the destructor, so the handler never outlives this */
+    auto on_signal = [this, on_signal_emitted = std::move(on_signal_emitted)](
+                         const char *, const char *, GVariant *parameters) {
+        on_signal_emitted(Message(parameters, m_trusted_peer));
+    };
+
+    const size_t id = SignalRegistry::of(m_connection.get()).subscribe(match, std::move(on_signal));
+
+    m_signal_subscriptions.insert(id);
+
+    return {reinterpret_cast<uintptr_t>(this), id};
+}
+
+void ConnectionImpl::unsubscribe_from_signal(const Subscription &subscription) noexcept
+{
+    if (subscription.proxy_id() != reinterpret_cast<uintptr_t>(this)
+        || !m_signal_subscriptions.erase(subscription.id())) {
+        return;
+    }
+
+    SignalRegistry::of(m_connection.get()).unsubscribe(subscription.id());
+}
+
+Message ConnectionImpl::call(const std::string &service,
+                             const std::string &object,
+                             const std::string &interface,
+                             const std::string &method,
+                             const Message &arguments,
+                             const Timeout &timeout) const
+{
+    return call(service, object, interface, method, arguments.as_gio_variant(), timeout);
+}
+
+Message ConnectionImpl::call(const std::string &service,
+                             const std::string &object,
+                             const std::string &interface,
+                             const std::string &method,
+                             GVariant *arguments,
+                             const Timeout &timeout) const
+{
+    GDBusConnection *connection = m_connection.get();
+    MethodCall call{"connection",
+                    service,
+                    object,
+                    interface,
+                    method,
+                    m_unique_name.empty(),
+                    m_trusted_peer,
+                    {}};
+
+    if (std::string reason = call.invalid_reason(); !reason.empty()) {
+        GIO_DBUS_CPP_THROW_ERROR(call.error_message(reason));
+    }
+
+    GError *error = nullptr;
+    GVariant *reply = g_dbus_connection_call_sync(connection,
+                                                  call.bus_name(),
+                                                  object.c_str(),
+                                                  interface.c_str(),
+                                                  method.c_str(),
+                                                  arguments,
+                                                  nullptr,
+                                                  G_DBUS_CALL_FLAGS_NONE,
+                                                  timeout.milliseconds(),
+                                                  nullptr,
+                                                  &error);
+
+    return call.finish(reply, error);
+}
+
+void ConnectionImpl::call_async(const std::string &service,
+                                const std::string &object,
+                                const std::string &interface,
+                                const std::string &method,
+                                const Message &arguments,
+                                const std::function<void(const Message &)> &on_success,
+                                const std::function<void(const Error &)> &on_error,
+                                const Timeout &timeout) const
+{
+    call_async(service,
+               object,
+               interface,
+               method,
+               arguments.as_gio_variant(),
+               on_success,
+               on_error,
+               timeout);
+}
+
+void ConnectionImpl::call_async(const std::string &service,
+                                const std::string &object,
+                                const std::string &interface,
+                                const std::string &method,
+                                GVariant *arguments,
+                                const std::function<void(const Message &)> &on_success,
+                                const std::function<void(const Error &)> &on_error,
+                                const Timeout &timeout) const
+{
+    GDBusConnection *connection = m_connection.get();
+    MethodCall method_call{"connection",
+                           service,
+                           object,
+                           interface,
+                           method,
+                           m_unique_name.empty(),
+                           m_trusted_peer,
+                           {}};
+
+    if (std::string reason = method_call.invalid_reason(); !reason.empty()) {
+        on_error(Error(GIO_DBUS_CPP_ERROR_NAME, method_call.error_message(reason)));
+        return;
+    }
+
+    std::unique_ptr<AsyncMethodCall> call(new AsyncMethodCall(method_call, on_success, on_error));
+
+    g_dbus_connection_call(connection,
+                           method_call.bus_name(),
+                           object.c_str(),
+                           interface.c_str(),
+                           method.c_str(),
+                           arguments,
+                           nullptr,
+                           G_DBUS_CALL_FLAGS_NONE,
+                           timeout.milliseconds(),
+                           nullptr,
+                           AsyncMethodCall::on_connection_call_ready,
+                           call.release());
+}
+
 GIO_DBUS_CPP_IMPLEMENT_PIMPL_PARTS(Connection, ConnectionImpl)
 
 Connection::Connection(ConnectionType connection_type)
@@ -201,6 +403,70 @@ const std::string &Connection::name() const noexcept
     return m_pimpl->name();
 }
 
+void Connection::set_trusted_peer(bool trusted)
+{
+    m_pimpl->set_trusted_peer(trusted);
+}
+
+bool Connection::is_trusted_peer() const noexcept
+{
+    return m_pimpl->is_trusted_peer();
+}
+
+Subscription Connection::subscribe_to_signal(const SignalMatch &match,
+                                             std::function<void(const Message &)> on_signal_emitted)
+{
+    return m_pimpl->subscribe_to_signal(match, std::move(on_signal_emitted));
+}
+
+void Connection::unsubscribe_from_signal(const Subscription &subscription) noexcept
+{
+    m_pimpl->unsubscribe_from_signal(subscription);
+}
+
+Message Connection::call(const std::string &service,
+                         const std::string &object,
+                         const std::string &interface,
+                         const std::string &method,
+                         const Timeout &timeout) const
+{
+    return m_pimpl->call(service, object, interface, method, nullptr, timeout);
+}
+
+Message Connection::call(const std::string &service,
+                         const std::string &object,
+                         const std::string &interface,
+                         const std::string &method,
+                         const Message &arguments,
+                         const Timeout &timeout) const
+{
+    return m_pimpl->call(service, object, interface, method, arguments, timeout);
+}
+
+void Connection::call_async(const std::string &service,
+                            const std::string &object,
+                            const std::string &interface,
+                            const std::string &method,
+                            const std::function<void(const Message &)> &on_success,
+                            const std::function<void(const Error &)> &on_error,
+                            const Timeout &timeout) const
+{
+    m_pimpl->call_async(service, object, interface, method, nullptr, on_success, on_error, timeout);
+}
+
+void Connection::call_async(const std::string &service,
+                            const std::string &object,
+                            const std::string &interface,
+                            const std::string &method,
+                            const Message &arguments,
+                            const std::function<void(const Message &)> &on_success,
+                            const std::function<void(const Error &)> &on_error,
+                            const Timeout &timeout) const
+{
+    m_pimpl->call_async(
+        service, object, interface, method, arguments, on_success, on_error, timeout);
+}
+
 GDBusConnection *Connection::as_gio_connection() const noexcept
 {
     return m_pimpl->as_gio_connection();
@@ -0,0 +1,149 @@
+#include "method-call.hpp"
+
+#include <memory>
+#include <optional>
+
+namespace Gio::DBus {
+
+std::string MethodCall::invalid_target_reason(std::string_view service,
+                                              std::string_view object,
+                                              std::string_view interface,
+                                              bool peer_to_peer)
+{
+    if (peer_to_peer && !service.empty()) {
+        return "peer-to-peer connections take no service name";
+    }
+
+    if (!peer_to_peer && !g_dbus_is_name(service.data())) {
+        return "invalid service name";
+    }
+
+    if (!g_variant_is_object_path(object.data())) {
+        return "invalid object path";
+    }
+
+    if (!g_dbus_is_interface_name(interface.data())) {
+        return "invalid interface name";
+    }
+
+    return {};
+}
+
+std::string MethodCall::invalid_method_reason() const
+{
+    if (!g_dbus_is_member_name(method.data())) {
+        return "invalid method name";
+    }
+
+    return {};
+}
+
+std::string MethodCall::invalid_reason() const
+{
+    if (std::string reason = invalid_target_reason(service, object, interface, peer_to_peer);
+        !reason.empty()) {
+        return reason;
+    }
+
+    return invalid_method_reason();
+}
+
+std::string MethodCall::error_message(std::string_view reason) const
+{
+    std::string message = "Failed to call ";
+    message.append(interface).append(".").append(method).append("() method using ");
+    message.append(caller);
+
+    if (peer_to_peer) {
+        message.append(" for the peer on ");
+    } else {
+        message.append(" for ").append(service).append(" service on ");
+    }
+
+    message.append(object).append(" object path (").append(reason).append(")");
+
+    return message;
+}
+
+const char *MethodCall::bus_name() const noexcept
+{
+    return peer_to_peer ? nullptr : service.data();
+}
+
+Message MethodCall::finish(GVariant *_reply, GError *_error) const
+{
+    std::unique_ptr<GError, decltype(&g_error_free)> error(_error, &g_error_free);
+    std::unique_ptr<GVariant, decltype(&g_variant_unref)> reply(_reply, &g_variant_unref);
+
+    if (error) {
+        GIO_DBUS_CPP_THROW_ERROR(error_message(error->message));
+    }
+
+    if (!reply) {
+        GIO_DBUS_CPP_THROW_ERROR(error_message("no reply"));
+    }
+
+    /* The message holds its own reference to the reply */
+    Message message(reply.get(), trusted);
+    message.set_decode_limits(decode_limits);
+
+    return message;
+}
+
+AsyncMethodCall::AsyncMethodCall(const MethodCall &call,
+                                 std::function<void(const Message &)> on_success,
+                                 std::function<void(const Error &)> on_error)
+    : MethodCall(call)
+    , on_success(std::move(on_success))
+    , on_error(std::move(on_error))
+    , m_service(call.service)
+    , m_object(call.object)
+    , m_interface(call.interface)
+    , m_method(call.method)
+{
+    service = m_service;
+    object = m_object;
+    interface = m_interface;
+    method = m_method;
+}
+
+void AsyncMethodCall::complete(GVariant *reply, GError *error) const
+{
+    std::optional<Message> message;
+
+    try {
+        message = finish(reply, error);
+    }
+    catch (const Error &error) {
+        on_error(error);
+        return;
+    }
+
+    on_success(*message);
+}
+
+void AsyncMethodCall::on_proxy_call_ready(GObject *object, GAsyncResult *result, void *user_data)
+{
+    std::unique_ptr<AsyncMethodCall> call(reinterpret_cast<AsyncMethodCall *>(user_data));
+
+    GError *error = nullptr;
+    GVariant *reply =
+        g_dbus_proxy_call_finish(reinterpret_cast<GDBusProxy *>(object), result, &error);
+
+    call->complete(reply, error);
+}
+
+void AsyncMethodCall::on_connection_call_ready(GObject *object,
+                                               GAsyncResult *result,
+                                               void *user_data)
+{
+    std::unique_ptr<AsyncMethodCall> call(reinterpret_cast<AsyncMethodCall *>(user_data));
+
+    GError *error = nullptr;
+    GVariant *reply =
+        g_dbus_connection_call_finish(reinterpret_cast<GDBusConnection *>(object), result, &error);
+
+    call->complete(reply, error);
+}
+
+} /* namespace Gio::DBus */
@@ -0,0 +1,80 @@
+#ifndef GIO_DBUS_CPP_METHOD_CALL_HPP
+#define GIO_DBUS_CPP_METHOD_CALL_HPP
+
+#include "decode-limits.hpp"
+#include "error.hpp"
+#include "message.hpp"
+
+#include <gio/gio.h>
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace Gio::DBus {
+
+/* A method call made through a proxy or directly on a connection, both turn replies into
+ * messages and errors into Gio::DBus::Error the same way. The names are views of nul-terminated
+ * strings owned by the caller of a synchronous call. Calls on peer-to-peer connections have an
+ * empty service, GDBus takes no bus name there. */
+struct MethodCall
+{
+    const char *caller;
+    std::string_view service;
+    std::string_view object;
+    std::string_view interface;
+    std::string_view method;
+    bool peer_to_peer;
+    bool trusted;
+    DecodeLimits decode_limits;
+
+    /* GDBus only warns about invalid names, so they are rejected before calling, these return
+     * an empty string if the names are valid */
+    static std::string invalid_target_reason(std::string_view service,
+                                             std::string_view object,
+                                             std::string_view interface,
+                                             bool peer_to_peer);
+    std::string invalid_method_reason() const;
+    std::string invalid_reason() const;
+
+    std::string error_message(std::string_view reason) const;
+
+    /* The bus name passed to GDBus, NULL on peer-to-peer connections */
+    const char *bus_name() const noexcept;
+
+    /* Takes ownership of the reply and of the error, throws Gio::DBus::Error on error or if
+     * GDBus returned neither of them, e.g. when it rejected the call as invalid */
+    Message finish(GVariant *reply, GError *error) const;
+};
+
+/* Owns copies of the names, the call may outlive the proxy or the caller that made it */
+struct AsyncMethodCall: MethodCall
+{
+    AsyncMethodCall(const MethodCall &call,
+                    std::function<void(const Message &)> on_success,
+                    std::function<void(const Error &)> on_error);
+
+    AsyncMethodCall(const AsyncMethodCall &) = delete;
+    AsyncMethodCall &operator=(const AsyncMethodCall &) = delete;
+
+    std::function<void(const Message &)> on_success;
+    std::function<void(const Error &)> on_error;
+
+    /* Takes ownership of the reply and of the error, reports either of them */
+    void complete(GVariant *reply, GError *error) const;
+
+    /* Ready callbacks of g_dbus_proxy_call and g_dbus_connection_call, the user data is an
+     * AsyncMethodCall created with new */
+    static void on_proxy_call_ready(GObject *object, GAsyncResult *result, void *user_data);
+    static void on_connection_call_ready(GObject *object, GAsyncResult *result, void *user_data);
+
+private:
+    std::string m_service;
+    std::string m_object;
+    std::string m_interface;
+    std::string m_method;
+};
+
+} /* namespace Gio::DBus */
+
+#endif /* GIO_DBUS_CPP_METHOD_CALL_HPP */
@@ -1,36 +1,115 @@
 #include "proxy.hpp"
 #include "connection.hpp"
+#include "method-call.hpp"
+#include "signal-dispatcher.hpp"
+#include "signal-registry.hpp"
 
+#include <cstring>
 #include <gio/gio.h>
 #include <iostream>
-#include <list>
-#include <optional>
+#include <mutex>
+#include <string_view>
 
 namespace {
 
-struct SubscriptionContext
+/* Signals of proxies are received through the signal registry of the connection instead */
+GDBusProxyFlags to_gio_proxy_flags(Gio::DBus::ProxyFlags flags) noexcept
 {
-    size_t subscription_id;
-    std::string signal_name;
-    std::function<void(const Gio::DBus::Message &)> on_signal_emitted;
-};
+    int gio_flags = G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS;
+
+    if (has_flag(flags, Gio::DBus::ProxyFlags::DoNotLoadProperties)) {
+        gio_flags |= G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES;
+    }
+
+    if (has_flag(flags, Gio::DBus::ProxyFlags::DoNotAutoStart)) {
+        gio_flags |= G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START;
+    }
+
+    if (has_flag(flags, Gio::DBus::ProxyFlags::DoNotAutoStartAtConstruction)) {
+        gio_flags |= G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START_AT_CONSTRUCTION;
+    }
+
+    return static_cast<GDBusProxyFlags>(gio_flags);
+}
+
+constexpr Gio::DBus::ProxyFlags without_flag(Gio::DBus::ProxyFlags flags,
+                                            Gio::DBus::ProxyFlags flag) noexcept
+{
+    return static_cast<Gio::DBus::ProxyFlags>(static_cast<unsigned int>(flags)
+                                              & ~static_cast<unsigned int>(flag));
+}
+
+std::string proxy_creation_error(std::string_view service,
+                                 std::string_view object,
+                                 std::string_view interface,
+                                 std::string_view message)
+{
+    std::string error = "Failed to create proxy for ";
+    error.append(service).append(" service on ").append(object).append(" object path on ");
+    error.append(interface).append(" interface (").append(message).append(")");
+
+    return error;
+}
 
 } /* namespace */
 
 namespace Gio::DBus {
 
+/* The GDBusProxy of a proxy, shared with the background creation of a lazy proxy, which
+ * completes and makes the calls queued until then even if the proxy is destroyed meanwhile */
+struct SharedProxy
+{
+    /* Asynchronous call waiting for the proxy, made from the main context it was issued from */
+    struct PendingCall
+    {
+        std::unique_ptr<AsyncMethodCall> call;
+        std::unique_ptr<GVariant, decltype(&g_variant_unref)> arguments;
+        int timeout;
+        std::unique_ptr<GMainContext, decltype(&g_main_context_unref)> context;
+        std::unique_ptr<GDBusProxy, decltype(&g_object_unref)> proxy;
+        std::string error;
+    };
+
+    std::mutex mutex;
+    std::unique_ptr<GDBusProxy, decltype(&g_object_unref)> proxy{nullptr, &g_object_unref};
+    bool is_creating = false;
+    std::vector<std::unique_ptr<PendingCall>> pending_calls;
+};
+
 class ProxyImpl
 {
 public:
     ProxyImpl(Connection &connection,
               std::string service,
               std::string object,
-              std::string interface);
+              std::string interface,
+              ProxyFlags flags);
+
+    /* Takes ownership of an already created proxy */
+    ProxyImpl(GDBusProxy *proxy,
+              std::string service,
+              std::string object,
+              std::string interface,
+              ProxyFlags flags,
+              bool trusted_peer);
+
     ~ProxyImpl();
 
+    static void create_async(Connection &connection,
+                             std::string service,
+                             std::string object,
+                             std::string interface,
+                             std::function<void(Proxy)> on_success,
+                             std::function<void(const Error &)> on_error,
+                             ProxyFlags flags);
+
     const std::string &service() const noexcept;
     const std::string &object() const noexcept;
     const std::string &interface() const noexcept;
+    ProxyFlags flags() const noexcept;
+
+    void set_decode_limits(const DecodeLimits &limits) noexcept;
+    const DecodeLimits &decode_limits() const noexcept;
 
     Message call(const std::string &method, const Timeout &timeout) const;
     Message call(const std::string &method, const Message &arguments, const Timeout &timeout) const;
@@ -50,63 +129,97 @@ public:
     void unsubscribe_from_signal(const Subscription &subscription) const;
 
 private:
-    static void on_async_call_ready(GObject *, GAsyncResult *, void *);
-    static void on_any_signal(GDBusProxy *, const char *, const char *, GVariant *, void *);
+    static void on_async_create_ready(GObject *, GAsyncResult *, void *);
+    static void on_lazy_create_ready(GObject *, GAsyncResult *, void *);
+    static int make_pending_call(void *pending_call);
+
+    GDBusProxy *proxy() const;
+    void start_lazy_create() const;
+    bool is_sent_by_name_owner(const char *sender) const;
+    void on_signal(const char *sender, const char *signal_name, GVariant *parameters) const;
+    Message call(const std::string &method, GVariant *arguments, const Timeout &timeout) const;
+    void call_async(const std::string &method,
+                    GVariant *arguments,
+                    const std::function<void(const Message &)> &on_success,
+                    const std::function<void(const Error &)> &on_error,
+                    const Timeout &timeout) const;
+
+    MethodCall method_call(std::string_view method) const;
 
     std::string m_service;
     std::string m_object;
     std::string m_interface;
-    std::vector<gulong> m_gio_signal_connections;
-    mutable size_t m_signal_subscriptions_count;
-    mutable std::list<SubscriptionContext> m_signal_subscriptions;
-    std::unique_ptr<GDBusProxy, decltype(&g_object_unref)> m_proxy;
+    ProxyFlags m_flags;
+    bool m_trusted_peer;
+    DecodeLimits m_decode_limits;
+    mutable SignalDispatcher m_signal_dispatcher;
+    mutable SignalRegistry *m_signal_registry = nullptr;
+    mutable size_t m_signal_registry_subscription = 0;
+    std::unique_ptr<GDBusConnection, decltype(&g_object_unref)> m_connection;
+    std::shared_ptr<SharedProxy> m_shared_proxy;
 };
 
-struct AsyncCallContext
+struct AsyncCreateContext
 {
-    const Gio::DBus::ProxyImpl &proxy_impl;
-    std::string method;
-    std::function<void(const Gio::DBus::Message &)> on_success;
-    std::function<void(const Gio::DBus::Error &)> on_error;
+    std::string service;
+    std::string object;
+    std::string interface;
+    ProxyFlags flags;
+    bool trusted_peer;
+    std::function<void(Proxy)> on_success;
+    std::function<void(const Error &)> on_error;
 };
 
 ProxyImpl::ProxyImpl(Connection &connection,
                      std::string service,
                      std::string object,
-                     std::string interface)
+                     std::string interface,
+                     ProxyFlags flags)
     : m_service(std::move(service))
     , m_object(std::move(object))
     , m_interface(std::move(interface))
-    , m_proxy(nullptr, &g_object_unref)
+    , m_flags(flags)
+    , m_trusted_peer(connection.is_trusted_peer())
+    , m_connection(
+          reinterpret_cast<GDBusConnection *>(g_object_ref(connection.as_gio_connection())),
+          &g_object_unref)
+    , m_shared_proxy(std::make_shared<SharedProxy>())
 {
-    GError *_error = nullptr;
-    GDBusProxy *_proxy = g_dbus_proxy_new_sync(connection.as_gio_connection(),
-                                               G_DBUS_PROXY_FLAGS_NONE,
-                                               nullptr,
-                                               m_service.data(),
-                                               m_object.c_str(),
-                                               m_interface.data(),
-                                               nullptr,
-                                               &_error);
-
-    std::unique_ptr<GError, decltype(&g_error_free)> error(_error, &g_error_free);
-
-    if (error) {
-        GIO_DBUS_CPP_THROW_ERROR(std::string("Failed to create proxy for ") + m_service
-                                 + " service on " + m_object + " object path on " + m_interface
-                                 + " interface (" + error->message + ")");
+    /* The names are validated once, calls only validate the method name */
+    if (std::string reason =
+            MethodCall::invalid_target_reason(m_service, m_object, m_interface, false);
+        !reason.empty()) {
+        GIO_DBUS_CPP_THROW_ERROR(proxy_creation_error(m_service, m_object, m_interface, reason));
     }
 
-    m_gio_signal_connections.push_back(
-        g_signal_connect(_proxy, "g-signal", G_CALLBACK(on_any_signal), this));
+    if (!has_flag(m_flags, ProxyFlags::Lazy)) {
+        proxy();
+    }
+}
 
-    m_proxy.reset(_proxy);
+ProxyImpl::ProxyImpl(GDBusProxy *proxy,
+                     std::string service,
+                     std::string object,
+                     std::string interface,
+                     ProxyFlags flags,
+                     bool trusted_peer)
+    : m_service(std::move(service))
+    , m_object(std::move(object))
+    , m_interface(std::move(interface))
+    , m_flags(flags)
+    , m_trusted_peer(trusted_peer)
+    , m_connection(
+          reinterpret_cast<GDBusConnection *>(g_object_ref(g_dbus_proxy_get_connection(proxy))),
+          &g_object_unref)
+    , m_shared_proxy(std::make_shared<SharedProxy>())
+{
+    m_shared_proxy->proxy.reset(proxy);
 }
 
 ProxyImpl::~ProxyImpl()
 {
-    for (const auto &gio_signal_connection: m_gio_signal_connections) {
-        g_signal_handler_disconnect(m_proxy.get(), gio_signal_connection);
+    if (m_signal_registry) {
+        m_signal_registry->unsubscribe(m_signal_registry_subscription);
     }
 }
 
@@ -125,52 +238,70 @@ const std::string &ProxyImpl::interface() const noexcept
     return m_interface;
 }
 
-Message ProxyImpl::call(const std::string &method, const Timeout &timeout) const
+ProxyFlags ProxyImpl::flags() const noexcept
 {
-    GError *_error = nullptr;
-    GVariant *_variant = g_dbus_proxy_call_sync(m_proxy.get(),
-                                                method.data(),
-                                                nullptr,
-                                                G_DBUS_CALL_FLAGS_NONE,
-                                                timeout.milliseconds(),
-                                                nullptr,
-                                                &_error);
+    return m_flags;
+}
 
-    std::unique_ptr<GError, decltype(&g_error_free)> error(_error, &g_error_free);
-    std::unique_ptr<GVariant, decltype(&g_variant_unref)> variant(_variant, &g_variant_unref);
+void ProxyImpl::create_async(Connection &connection,
+                             std::string service,
+                             std::string object,
+                             std::string interface,
+                             std::function<void(Proxy)> on_success,
+                             std::function<void(const Error &)> on_error,
+                             ProxyFlags flags)
+{
+    /* The proxy is created right away, so it isn't lazy */
+    flags = without_flag(flags, ProxyFlags::Lazy);
 
-    if (error) {
-        GIO_DBUS_CPP_THROW_ERROR(std::string("Failed to call ") + interface() + "." + method
-                                 + "() method using proxy for " + service() + " service on "
-                                 + object() + " object path (" + error->message + ")");
+    if (std::string reason = MethodCall::invalid_target_reason(service, object, interface, false);
+        !reason.empty()) {
+        on_error(Error(GIO_DBUS_CPP_ERROR_NAME,
+                       proxy_creation_error(service, object, interface, reason)));
+        return;
     }
 
-    return {variant.release()};
+    AsyncCreateContext *context = new AsyncCreateContext{
+        std::move(service),
+        std::move(object),
+        std::move(interface),
+        flags,
+        connection.is_trusted_peer(),
+        std::move(on_success),
+        std::move(on_error),
+    };
+
+    g_dbus_proxy_new(connection.as_gio_connection(),
+                     to_gio_proxy_flags(flags),
+                     nullptr,
+                     context->service.c_str(),
+                     context->object.c_str(),
+                     context->interface.c_str(),
+                     nullptr,
+                     on_async_create_ready,
+                     context);
 }
 
-Message ProxyImpl::call(const std::string &method,
-                        const Message &arguments,
-                        const Timeout &timeout) const
+void ProxyImpl::set_decode_limits(const DecodeLimits &limits) noexcept
 {
-    GError *_error = nullptr;
-    GVariant *_variant = g_dbus_proxy_call_sync(m_proxy.get(),
-                                                method.data(),
-                                                arguments.as_gio_variant(),
-                                                G_DBUS_CALL_FLAGS_NONE,
-                                                timeout.milliseconds(),
-                                                nullptr,
-                                                &_error);
+    m_decode_limits = limits;
+}
 
-    std::unique_ptr<GError, decltype(&g_error_free)> error(_error, &g_error_free);
-    std::unique_ptr<GVariant, decltype(&g_variant_unref)> variant(_variant, &g_variant_unref);
+const DecodeLimits &ProxyImpl::decode_limits() const noexcept
+{
+    return m_decode_limits;
+}
 
-    if (error) {
-        GIO_DBUS_CPP_THROW_ERROR(std::string("Failed to call ") + interface() + "." + method
-                                 + "() method using proxy for " + service() + " service on "
-                                 + object() + " object path (" + error->message + ")");
-    }
+Message ProxyImpl::call(const std::string &method, const Timeout &timeout) const
+{
+    return call(method, nullptr, timeout);
+}
 
-    return {variant.release()};
+Message ProxyImpl::call(const std::string &method,
+                        const Message &arguments,
+                        const Timeout &timeout) const
+{
+    return call(method, arguments.as_gio_variant(), timeout);
 }
 
 void ProxyImpl::call_async(const std::string &method,
@@ -178,19 +309,7 @@ void ProxyImpl::call_async(const std::string &method,
                            const std::function<void(const Error &)> &on_error,
                            const Timeout &timeout) const
 {
-    g_dbus_proxy_call(m_proxy.get(),
-                      method.data(),
-                      nullptr,
-                      G_DBUS_CALL_FLAGS_NONE,
-                      timeout.milliseconds(),
-                      nullptr,
-                      on_async_call_ready,
-                      new AsyncCallContext{
-                          *this,
-                          method,
-                          on_success,
-                          on_error,
-                      });
+    call_async(method, nullptr, on_success, on_error, timeout);
 }
 
 void ProxyImpl::call_async(const std::string &method,
@@ -199,31 +318,34 @@ void ProxyImpl::call_async(const std::string &method,
                            const std::function<void(const Error &)> &on_error,
                            const Timeout &timeout) const
 {
-    g_dbus_proxy_call(m_proxy.get(),
-                      method.data(),
-                      arguments.as_gio_variant(),
-                      G_DBUS_CALL_FLAGS_NONE,
-                      timeout.milliseconds(),
-                      nullptr,
-                      on_async_call_ready,
-                      new AsyncCallContext{
-                          *this,
-                          method,
-                          on_success,
-                          on_error,
-                      });
+    call_async(method, arguments.as_gio_variant(), on_success, on_error, timeout);
 }
 
 Subscription ProxyImpl::subscribe_to_signal(
     std::string signal_name, std::function<void(const Message &)> on_signal_emitted) const
 {
-    m_signal_subscriptions.push_back({
-        m_signal_subscriptions_count,
-        std::move(signal_name),
-        std::move(on_signal_emitted),
-    });
+    /* Signals of the proxy are received through the registry of the connection, which shares
+     * the match rule among all proxies of the same object and interface */
+    if (!m_signal_registry) {
+        SignalMatch match;
+        match.sender = m_service;
+        match.interface = m_interface;
+        match.object = m_object;
+
+        SignalRegistry &registry = SignalRegistry::of(m_connection.get());
+        m_signal_registry_subscription = registry.subscribe(
+            match, [this](const char *sender, const char *signal_name, GVariant *parameters) {
+                on_signal(sender, signal_name, parameters);
+            });
+        m_signal_registry = &registry;
+
+        /* Signals are accepted only once the proxy knows the owner of the service name */
+        std::lock_guard<std::mutex> lock(m_shared_proxy->mutex);
+        start_lazy_create();
+    }
 
-    return {reinterpret_cast<uintptr_t>(this), m_signal_subscriptions_count++};
+    return {reinterpret_cast<uintptr_t>(this),
+            m_signal_dispatcher.subscribe(signal_name, std::move(on_signal_emitted))};
 }
 
 void ProxyImpl::unsubscribe_from_signal(const Subscription &subscription) const
@@ -232,68 +354,319 @@ void ProxyImpl::unsubscribe_from_signal(const Subscription &subscription) const
         return;
     }
 
-    m_signal_subscriptions.remove_if([&subscription](const SubscriptionContext &context) {
-        return context.subscription_id == subscription.id();
-    });
+    m_signal_dispatcher.unsubscribe(subscription.id());
 }
 
-void ProxyImpl::on_async_call_ready(GObject *object, GAsyncResult *result, void *user_data)
+void ProxyImpl::on_async_create_ready(GObject *, GAsyncResult *result, void *user_data)
 {
     GError *_error = nullptr;
-    GDBusProxy *_proxy = reinterpret_cast<decltype(_proxy)>(object);
-    GVariant *_variant = g_dbus_proxy_call_finish(_proxy, result, &_error);
+    GDBusProxy *_proxy = g_dbus_proxy_new_finish(result, &_error);
 
     std::unique_ptr<GError, decltype(&g_error_free)> error(_error, &g_error_free);
-    std::unique_ptr<GVariant, decltype(&g_variant_unref)> variant(_variant, &g_variant_unref);
-    std::unique_ptr<AsyncCallContext> context(reinterpret_cast<AsyncCallContext *>(user_data));
+    std::unique_ptr<AsyncCreateContext> context(reinterpret_cast<AsyncCreateContext *>(user_data));
 
     if (error) {
         context->on_error(Gio::DBus::Error(GIO_DBUS_CPP_ERROR_NAME,
-                                           std::string("Failed to call ")
-                                               + context->proxy_impl.interface() + "."
-                                               + context->method + "() method using proxy for "
-                                               + context->proxy_impl.service() + " service on "
-                                               + context->proxy_impl.object() + " object path ("
-                                               + error->message + ")"));
-    } else {
-        std::optional<Message> message;
+                                           proxy_creation_error(context->service,
+                                                                context->object,
+                                                                context->interface,
+                                                                error->message)));
+        return;
+    }
+
+    context->on_success(Proxy(std::make_unique<ProxyImpl>(_proxy,
+                                                          std::move(context->service),
+                                                          std::move(context->object),
+                                                          std::move(context->interface),
+                                                          context->flags,
+                                                          context->trusted_peer)));
+}
+
+/* Before GLib 2.80.1 GDBus delivered signals matched on a well-known sender name from any
+ * sender, so they are accepted only from the current owner of the name tracked by the proxy */
+bool ProxyImpl::is_sent_by_name_owner(const char *sender) const
+{
+    if (g_dbus_is_unique_name(m_service.c_str())) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(m_shared_proxy->mutex);
+
+    if (!m_shared_proxy->proxy) {
+        return false;
+    }
+
+    std::unique_ptr<char, decltype(&g_free)> owner(
+        g_dbus_proxy_get_name_owner(m_shared_proxy->proxy.get()), &g_free);
+
+    return owner && sender && std::strcmp(owner.get(), sender) == 0;
+}
+
+void ProxyImpl::on_signal(const char *sender, const char *signal_name, GVariant *parameters) const
+{
+    if (!is_sent_by_name_owner(sender)) {
+        return;
+    }
+
+    m_signal_dispatcher.dispatch(signal_name, [&] {
+        Message message(parameters, m_trusted_peer);
+        message.set_decode_limits(m_decode_limits);
+
+        return message;
+    });
+}
+
+/* Replies carry the decode limits of the proxy */
+MethodCall ProxyImpl::method_call(std::string_view method) const
+{
+    return {
+        "proxy", m_service, m_object, m_interface, method, false, m_trusted_peer, m_decode_limits};
+}
+
+Message ProxyImpl::call(const std::string &method,
+                        GVariant *arguments,
+                        const Timeout &timeout) const
+{
+    MethodCall call = method_call(method);
+
+    if (std::string reason = call.invalid_method_reason(); !reason.empty()) {
+        GIO_DBUS_CPP_THROW_ERROR(call.error_message(reason));
+    }
+
+    GError *error = nullptr;
+    GVariant *reply = g_dbus_proxy_call_sync(proxy(),
+                                             method.c_str(),
+                                             arguments,
+                                             G_DBUS_CALL_FLAGS_NONE,
+                                             timeout.milliseconds(),
+                                             nullptr,
+                                             &error);
+
+    return call.finish(reply, error);
+}
+
+void ProxyImpl::call_async(const std::string &method,
+                           GVariant *arguments,
+                           const std::function<void(const Message &)> &on_success,
+                           const std::function<void(const Error &)> &on_error,
+                           const Timeout &timeout) const
+{
+    MethodCall method_call = this->method_call(method);
+
+    if (std::string reason = method_call.invalid_method_reason(); !reason.empty()) {
+        on_error(Error(GIO_DBUS_CPP_ERROR_NAME, method_call.error_message(reason)));
+        return;
+    }
+
+    /* Only asynchronous calls copy the names, they may outlive the proxy */
+    std::unique_ptr<AsyncMethodCall> call(new AsyncMethodCall(method_call, on_success, on_error));
+
+    GDBusProxy *proxy = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(m_shared_proxy->mutex);
+        proxy = m_shared_proxy->proxy.get();
+
+        /* Calls of a lazy proxy wait until it is created in the background */
+        if (!proxy) {
+            auto pending_call = std::make_unique<SharedProxy::PendingCall>(SharedProxy::PendingCall{
+                std::move(call),
+                {arguments ? g_variant_ref_sink(arguments) : nullptr, &g_variant_unref},
+                timeout.milliseconds(),
+                {g_main_context_ref_thread_default(), &g_main_context_unref},
+                {nullptr, &g_object_unref},
+                {},
+            });
+
+            m_shared_proxy->pending_calls.push_back(std::move(pending_call));
+            start_lazy_create();
 
-        try {
-            message = Message(variant.release());
-        }
-        catch (const Error &error) {
-            context->on_error(error);
             return;
         }
+    }
+
+    g_dbus_proxy_call(proxy,
+                      method.c_str(),
+                      arguments,
+                      G_DBUS_CALL_FLAGS_NONE,
+                      timeout.milliseconds(),
+                      nullptr,
+                      AsyncMethodCall::on_proxy_call_ready,
+                      call.release());
+}
+
+/* Synchronous calls of a lazy proxy create it on the first use without holding the lock, so
+ * they don't block asynchronous calls queued meanwhile, a failed creation is retried on the
+ * next use */
+GDBusProxy *ProxyImpl::proxy() const
+{
+    {
+        std::lock_guard<std::mutex> lock(m_shared_proxy->mutex);
+
+        if (m_shared_proxy->proxy) {
+            return m_shared_proxy->proxy.get();
+        }
+    }
+
+    GError *_error = nullptr;
+    GDBusProxy *_proxy = g_dbus_proxy_new_sync(m_connection.get(),
+                                               to_gio_proxy_flags(m_flags),
+                                               nullptr,
+                                               m_service.data(),
+                                               m_object.c_str(),
+                                               m_interface.data(),
+                                               nullptr,
+                                               &_error);
 
-        context->on_success(*message);
+    std::unique_ptr<GError, decltype(&g_error_free)> error(_error, &g_error_free);
+
+    if (error) {
+        GIO_DBUS_CPP_THROW_ERROR(
+            proxy_creation_error(m_service, m_object, m_interface, error->message));
+    }
+
+    std::lock_guard<std::mutex> lock(m_shared_proxy->mutex);
+
+    /* Another call may have created the proxy meanwhile, which stays the proxy in use */
+    if (m_shared_proxy->proxy) {
+        g_object_unref(_proxy);
+    } else {
+        m_shared_proxy->proxy.reset(_proxy);
     }
+
+    return m_shared_proxy->proxy.get();
 }
 
-void ProxyImpl::on_any_signal(
-    GDBusProxy *, const char *, const char *signal_name, GVariant *parameters, void *user_data)
+/* Called with the lock of the shared proxy held */
+void ProxyImpl::start_lazy_create() const
 {
-    ProxyImpl *proxy_impl = reinterpret_cast<ProxyImpl *>(user_data);
+    if (m_shared_proxy->proxy || m_shared_proxy->is_creating) {
+        return;
+    }
 
-    for (const auto &subscription_context: proxy_impl->m_signal_subscriptions) {
-        if (subscription_context.signal_name == signal_name) {
-            subscription_context.on_signal_emitted(parameters);
+    m_shared_proxy->is_creating = true;
+
+    g_dbus_proxy_new(m_connection.get(),
+                     to_gio_proxy_flags(m_flags),
+                     nullptr,
+                     m_service.c_str(),
+                     m_object.c_str(),
+                     m_interface.c_str(),
+                     nullptr,
+                     on_lazy_create_ready,
+                     new std::shared_ptr<SharedProxy>(m_shared_proxy));
+}
+
+void ProxyImpl::on_lazy_create_ready(GObject *, GAsyncResult *result, void *user_data)
+{
+    std::unique_ptr<std::shared_ptr<SharedProxy>> shared_proxy(
+        reinterpret_cast<std::shared_ptr<SharedProxy> *>(user_data));
+
+    GError *_error = nullptr;
+    GDBusProxy *_proxy = g_dbus_proxy_new_finish(result, &_error);
+
+    std::unique_ptr<GError, decltype(&g_error_free)> error(_error, &g_error_free);
+    std::vector<std::unique_ptr<SharedProxy::PendingCall>> pending_calls;
+    GDBusProxy *proxy = nullptr;
+
+    {
+        SharedProxy &shared = **shared_proxy;
+        std::lock_guard<std::mutex> lock(shared.mutex);
+
+        if (_proxy && !shared.proxy) {
+            shared.proxy.reset(_proxy);
+        } else if (_proxy) {
+            g_object_unref(_proxy);
         }
+
+        shared.is_creating = false;
+        proxy = shared.proxy.get();
+        pending_calls.swap(shared.pending_calls);
+    }
+
+    for (auto &pending_call: pending_calls) {
+        if (proxy) {
+            pending_call->proxy.reset(reinterpret_cast<GDBusProxy *>(g_object_ref(proxy)));
+        } else {
+            const MethodCall &call = *pending_call->call;
+            pending_call->error =
+                proxy_creation_error(call.service, call.object, call.interface, error->message);
+        }
+
+        GMainContext *context = pending_call->context.get();
+
+        g_main_context_invoke_full(context,
+                                   G_PRIORITY_DEFAULT,
+                                   make_pending_call,
+                                   pending_call.release(),
+                                   [](void *pending_call) {
+                                       delete reinterpret_cast<SharedProxy::PendingCall *>(
+                                           pending_call);
+                                   });
     }
 }
 
+/* Runs in the main context the call was issued from, so the reply is delivered there as well */
+int ProxyImpl::make_pending_call(void *user_data)
+{
+    auto *pending_call = reinterpret_cast<SharedProxy::PendingCall *>(user_data);
+
+    if (!pending_call->proxy) {
+        pending_call->call->on_error(Error(GIO_DBUS_CPP_ERROR_NAME, pending_call->error));
+        return G_SOURCE_REMOVE;
+    }
+
+    g_main_context_push_thread_default(pending_call->context.get());
+
+    g_dbus_proxy_call(pending_call->proxy.get(),
+                      pending_call->call->method.data(),
+                      pending_call->arguments.get(),
+                      G_DBUS_CALL_FLAGS_NONE,
+                      pending_call->timeout,
+                      nullptr,
+                      AsyncMethodCall::on_proxy_call_ready,
+                      pending_call->call.release());
+
+    g_main_context_pop_thread_default(pending_call->context.get());
+
+    return G_SOURCE_REMOVE;
+}
+
 GIO_DBUS_CPP_IMPLEMENT_PIMPL_PARTS(Proxy, ProxyImpl)
 
 Proxy::Proxy(Connection &connection,
              std::string service,
              std::string object_path,
-             std::string interface)
+             std::string interface,
+             ProxyFlags flags)
     : m_pimpl(std::make_unique<ProxyImpl>(connection,
                                           std::move(service),
                                           std::move(object_path),
-                                          std::move(interface)))
+                                          std::move(interface),
+                                          flags))
+{}
+
+Proxy::Proxy(std::unique_ptr<ProxyImpl> pimpl) noexcept
+    : m_pimpl(std::move(pimpl))
 {}
 
+void Proxy::create_async(Connection &connection,
+                         std::string service,
+                         std::string object,
+                         std::string interface,
+                         std::function<void(Proxy)> on_success,
+                         std::function<void(const Error &)> on_error,
+                         ProxyFlags flags)
+{
+    ProxyImpl::create_async(connection,
+                            std::move(service),
+                            std::move(object),
+                            std::move(interface),
+                            std::move(on_success),
+                            std::move(on_error),
+                            flags);
+}
+
 const std::string &Proxy::service() const noexcept
 {
     return m_pimpl->service();
@@ -309,6 +682,21 @@ const std::string &Proxy::interface() const noexcept
     return m_pimpl->interface();
 }
 
+ProxyFlags Proxy::flags() const noexcept
+{
+    return m_pimpl->flags();
+}
+
+void Proxy::set_decode_limits(const DecodeLimits &limits) noexcept
+{
+    m_pimpl->set_decode_limits(limits);
+}
+
+const DecodeLimits &Proxy::decode_limits() const noexcept
+{
+    return m_pimpl->decode_limits();
+}
+
 Message Proxy::call(const std::string &method, const Timeout &timeout) const
 {
     return m_pimpl->call(method, timeout);
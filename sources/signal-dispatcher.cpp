@@ -0,0 +1,104 @@
+#include "signal-dispatcher.hpp"
+
+namespace Gio::DBus {
+
+SignalDispatcher::DispatchGuard::DispatchGuard(SignalDispatcher &dispatcher) noexcept
+    : m_dispatcher(dispatcher)
+{
+    ++m_dispatcher.m_dispatch_depth;
+}
+
+SignalDispatcher::DispatchGuard::~DispatchGuard()
+{
+    if (--m_dispatcher.m_dispatch_depth > 0) {
+        return;
+    }
+
+    std::vector<size_t> released;
+    released.swap(m_dispatcher.m_released_after_dispatch);
+
+    for (size_t id: released) {
+        auto entry = m_dispatcher.m_entries.find(id);
+
+        if (entry != m_dispatcher.m_entries.end()) {
+            m_dispatcher.release(entry->second);
+        }
+    }
+}
+
+size_t SignalDispatcher::subscribe(const std::string &signal_name, Handler handler)
+{
+    const size_t id = m_next_id++;
+    const GQuark signal = g_quark_from_string(signal_name.c_str());
+
+    auto [entry, _] = m_entries.emplace(id, Entry{id, signal, true, std::move(handler)});
+    m_slots[signal].entries.push_back(&entry->second);
+
+    return id;
+}
+
+void SignalDispatcher::unsubscribe(size_t id)
+{
+    auto entry = m_entries.find(id);
+
+    if (entry == m_entries.end() || !entry->second.active) {
+        return;
+    }
+
+    entry->second.active = false;
+    ++m_slots[entry->second.signal].inactive;
+
+    /* The handler may be the one being called right now */
+    if (m_dispatch_depth > 0) {
+        m_released_after_dispatch.push_back(id);
+    } else {
+        release(entry->second);
+    }
+}
+
+SignalDispatcher::Slot *SignalDispatcher::find(const char *signal_name) noexcept
+{
+    /* A name that was never interned has no handlers */
+    const GQuark signal = g_quark_try_string(signal_name);
+
+    if (!signal) {
+        return nullptr;
+    }
+
+    auto slot = m_slots.find(signal);
+    return slot != m_slots.end() ? &slot->second : nullptr;
+}
+
+void SignalDispatcher::release(Entry &entry) noexcept
+{
+    entry.handler = nullptr;
+    compact(entry.signal);
+}
+
+/* Removing entries one by one would make unsubscribe linear in the number of handlers of the
+ * signal, so they are removed once at least half of them are inactive */
+void SignalDispatcher::compact(GQuark signal) noexcept
+{
+    auto slot = m_slots.find(signal);
+
+    if (slot == m_slots.end() || slot->second.inactive * 2 < slot->second.entries.size()) {
+        return;
+    }
+
+    std::erase_if(slot->second.entries, [this](const Entry *entry) {
+        if (entry->active) {
+            return false;
+        }
+
+        m_entries.erase(entry->id);
+        return true;
+    });
+
+    slot->second.inactive = 0;
+
+    if (slot->second.entries.empty()) {
+        m_slots.erase(slot);
+    }
+}
+
+} /* namespace Gio::DBus */
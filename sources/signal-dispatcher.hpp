@@ -0,0 +1,106 @@
+#ifndef GIO_DBUS_CPP_SIGNAL_DISPATCHER_HPP
+#define GIO_DBUS_CPP_SIGNAL_DISPATCHER_HPP
+
+#include "message.hpp"
+
+#include <gio/gio.h>
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Gio::DBus {
+
+/*
+ * Routes the signals of a proxy to its handlers. Handlers are grouped by the quark of the signal
+ * name, so dispatching costs one lookup regardless of how many handlers are subscribed, and are
+ * found by id on unsubscribe. Handlers may subscribe and unsubscribe while being dispatched, the
+ * unsubscribed ones are marked inactive and released once the dispatch is over.
+ */
+class SignalDispatcher
+{
+public:
+    using Handler = std::function<void(const Message &)>;
+
+    size_t subscribe(const std::string &signal_name, Handler handler);
+    void unsubscribe(size_t id);
+
+    /* Creates the message only if there are active handlers for the signal */
+    template<typename MakeMessage>
+    void dispatch(const char *signal_name, MakeMessage &&make_message);
+
+private:
+    struct Entry
+    {
+        size_t id;
+        GQuark signal;
+        bool active;
+        Handler handler;
+    };
+
+    /* Entries of one signal in subscription order, inactive ones are removed in batches */
+    struct Slot
+    {
+        std::vector<Entry *> entries;
+        size_t inactive = 0;
+    };
+
+    class DispatchGuard
+    {
+    public:
+        explicit DispatchGuard(SignalDispatcher &dispatcher) noexcept;
+        ~DispatchGuard();
+
+        DispatchGuard(const DispatchGuard &) = delete;
+        DispatchGuard &operator=(const DispatchGuard &) = delete;
+
+    private:
+        SignalDispatcher &m_dispatcher;
+    };
+
+    Slot *find(const char *signal_name) noexcept;
+    void release(Entry &entry) noexcept;
+    void compact(GQuark signal) noexcept;
+
+    size_t m_next_id = 1;
+    size_t m_dispatch_depth = 0;
+    std::vector<size_t> m_released_after_dispatch;
+    std::unordered_map<size_t, Entry> m_entries;
+    std::unordered_map<GQuark, Slot> m_slots;
+};
+
+template<typename MakeMessage>
+void SignalDispatcher::dispatch(const char *signal_name, MakeMessage &&make_message)
+{
+    Slot *slot = find(signal_name);
+
+    if (!slot || slot->entries.size() == slot->inactive) {
+        return;
+    }
+
+    DispatchGuard guard(*this);
+    std::optional<Message> message;
+
+    /* Handlers subscribed during the dispatch are called starting from the next signal */
+    const size_t size = slot->entries.size();
+
+    for (size_t i = 0; i < size; ++i) {
+        const Entry *entry = slot->entries[i];
+
+        if (!entry->active) {
+            continue;
+        }
+
+        if (!message) {
+            message = make_message();
+        }
+
+        entry->handler(*message);
+    }
+}
+
+} /* namespace Gio::DBus */
+
+#endif /* GIO_DBUS_CPP_SIGNAL_DISPATCHER_HPP */
@@ -0,0 +1,380 @@
+#include "signal-registry.hpp"
+
+#include "details/dbus-validation.hpp"
+#include "details/exception.hpp"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr const char *signal_registry_key = "gio-dbus-cpp-signal-registry";
+
+constexpr unsigned int max_signal_match_arg = 63;
+
+const char *nullable(const std::string &string) noexcept
+{
+    return string.empty() ? nullptr : string.c_str();
+}
+
+/* GDBus only warns about invalid names and rejects the subscription */
+void validate_signal_match(const Gio::DBus::SignalMatch &match)
+{
+    if (!match.sender.empty() && !g_dbus_is_name(match.sender.c_str())) {
+        GIO_DBUS_CPP_THROW_ERROR("Failed to subscribe to signal, invalid sender name '"
+                                 + match.sender + "'");
+    }
+
+    if (!match.interface.empty() && !g_dbus_is_interface_name(match.interface.c_str())) {
+        GIO_DBUS_CPP_THROW_ERROR("Failed to subscribe to signal, invalid interface name '"
+                                 + match.interface + "'");
+    }
+
+    if (!match.member.empty() && !g_dbus_is_member_name(match.member.c_str())) {
+        GIO_DBUS_CPP_THROW_ERROR("Failed to subscribe to signal, invalid signal name '"
+                                 + match.member + "'");
+    }
+
+    if (!match.object.empty() && !Gio::DBus::Details::dbus_is_object_path(match.object)) {
+        GIO_DBUS_CPP_THROW_ERROR("Failed to subscribe to signal, invalid object path '"
+                                 + match.object + "'");
+    }
+
+    if (!match.object_namespace.empty()
+        && !Gio::DBus::Details::dbus_is_object_path(match.object_namespace)) {
+        GIO_DBUS_CPP_THROW_ERROR("Failed to subscribe to signal, invalid object namespace '"
+                                 + match.object_namespace + "'");
+    }
+
+    if (!match.object.empty() && !match.object_namespace.empty()) {
+        GIO_DBUS_CPP_THROW_ERROR(
+            "Failed to subscribe to signal, object and object namespace can't be combined");
+    }
+
+    if (!match.args.empty() && match.args.rbegin()->first > max_signal_match_arg) {
+        GIO_DBUS_CPP_THROW_ERROR("Failed to subscribe to signal, argument "
+                                 + std::to_string(match.args.rbegin()->first)
+                                 + " is out of range, arguments up to "
+                                 + std::to_string(max_signal_match_arg) + " can be matched");
+    }
+
+    if (match.args.count(0) && !match.arg0_namespace.empty()) {
+        GIO_DBUS_CPP_THROW_ERROR(
+            "Failed to subscribe to signal, argument 0 and its namespace can't be combined");
+    }
+}
+
+/* GDBus matches on sender, interface, member, object and the first argument by itself */
+bool needs_filter_in_process(const Gio::DBus::SignalMatch &match) noexcept
+{
+    return !match.object_namespace.empty()
+           || (!match.args.empty() && match.args.rbegin()->first > 0);
+}
+
+/* Values of match rules are quoted with apostrophes, an apostrophe itself is written as '\'' */
+void append_match_rule_key(std::string &rule, const std::string &key, const std::string &value)
+{
+    rule += ',';
+    rule += key;
+    rule += "='";
+
+    for (char character: value) {
+        if (character == '\'') {
+            rule += "'\\''";
+        } else {
+            rule += character;
+        }
+    }
+
+    rule += '\'';
+}
+
+std::string signal_match_to_rule(const Gio::DBus::SignalMatch &match)
+{
+    std::string rule = "type='signal'";
+
+    const std::pair<const char *, const std::string &> keys[] = {
+        {"sender", match.sender},
+        {"interface", match.interface},
+        {"member", match.member},
+        {"path", match.object},
+        {"path_namespace", match.object_namespace},
+        {"arg0namespace", match.arg0_namespace},
+    };
+
+    for (const auto &[key, value]: keys) {
+        if (!value.empty()) {
+            append_match_rule_key(rule, key, value);
+        }
+    }
+
+    for (const auto &[index, value]: match.args) {
+        append_match_rule_key(rule, "arg" + std::to_string(index), value);
+    }
+
+    return rule;
+}
+
+bool is_in_object_namespace(std::string_view object, std::string_view object_namespace) noexcept
+{
+    if (object_namespace == "/" || object == object_namespace) {
+        return true;
+    }
+
+    return object.size() > object_namespace.size() && object.starts_with(object_namespace)
+           && object[object_namespace.size()] == '/';
+}
+
+/* As in match rules, arguments are matched only if they are strings */
+bool is_matching_in_process(const Gio::DBus::SignalMatch &match,
+                            const char *object,
+                            GVariant *parameters) noexcept
+{
+    if (!match.object_namespace.empty()
+        && !is_in_object_namespace(object, match.object_namespace)) {
+        return false;
+    }
+
+    const size_t arguments_count = g_variant_n_children(parameters);
+
+    for (const auto &[index, value]: match.args) {
+        if (index == 0) {
+            continue;
+        }
+
+        if (index >= arguments_count) {
+            return false;
+        }
+
+        GVariant *argument = g_variant_get_child_value(parameters, index);
+        const bool is_matching = g_variant_is_of_type(argument, G_VARIANT_TYPE_STRING)
+                                 && value == g_variant_get_string(argument, nullptr);
+        g_variant_unref(argument);
+
+        if (!is_matching) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} /* namespace */
+
+namespace Gio::DBus {
+
+struct SignalRegistry::Rule
+{
+    struct Subscriber
+    {
+        Handler handler;
+        std::atomic<bool> active = true;
+    };
+
+    SignalRegistry &registry;
+    std::string key;
+    std::string rule;
+    SignalMatch match;
+    bool filter_in_process;
+    unsigned int gio_subscription = 0;
+    std::map<size_t, std::shared_ptr<Subscriber>> subscribers;
+};
+
+SignalRegistry::SignalRegistry(GDBusConnection *connection) noexcept
+    : m_connection(connection)
+{}
+
+SignalRegistry &SignalRegistry::of(GDBusConnection *connection)
+{
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    SignalRegistry *registry = reinterpret_cast<SignalRegistry *>(
+        g_object_get_data(G_OBJECT(connection), signal_registry_key));
+
+    if (!registry) {
+        registry = new SignalRegistry(connection);
+        g_object_set_data_full(G_OBJECT(connection), signal_registry_key, registry, [](void *data) {
+            delete reinterpret_cast<SignalRegistry *>(data);
+        });
+    }
+
+    return *registry;
+}
+
+size_t SignalRegistry::subscribe(const SignalMatch &match, Handler handler)
+{
+    validate_signal_match(match);
+
+    /* GDBus calls handlers in the main context they were subscribed from, so subscriptions from
+     * different contexts can't share a GDBus subscription */
+    std::string rule = signal_match_to_rule(match);
+    GMainContext *context = g_main_context_get_thread_default();
+    std::string key = std::to_string(reinterpret_cast<uintptr_t>(context)) + rule;
+
+    auto subscriber = std::make_shared<Rule::Subscriber>();
+    subscriber->handler = std::move(handler);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto existing = m_rules.find(key);
+    Rule *entry = existing != m_rules.end() ? existing->second
+                                            : add_rule(std::move(key), std::move(rule), match);
+
+    const size_t id = m_next_id++;
+    entry->subscribers.emplace(id, std::move(subscriber));
+    m_subscriptions.emplace(id, entry);
+
+    return id;
+}
+
+void SignalRegistry::unsubscribe(size_t id) noexcept
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto subscription = m_subscriptions.find(id);
+
+    if (subscription == m_subscriptions.end()) {
+        return;
+    }
+
+    Rule *rule = subscription->second;
+    m_subscriptions.erase(subscription);
+
+    /* The subscriber may be part of a fan out in progress, which skips it from now on */
+    auto subscriber = rule->subscribers.find(id);
+    subscriber->second->active = false;
+    rule->subscribers.erase(subscriber);
+
+    if (rule->subscribers.empty()) {
+        remove_rule(rule);
+    }
+}
+
+SignalRegistry::Rule *SignalRegistry::add_rule(std::string key,
+                                               std::string rule,
+                                               const SignalMatch &match)
+{
+    const bool filter_in_process = needs_filter_in_process(match);
+    int flags = G_DBUS_SIGNAL_FLAGS_NONE;
+    const char *arg0 = nullptr;
+
+    if (auto argument = match.args.find(0); argument != match.args.end()) {
+        arg0 = argument->second.c_str();
+    } else if (!match.arg0_namespace.empty()) {
+        arg0 = match.arg0_namespace.c_str();
+        flags |= G_DBUS_SIGNAL_FLAGS_MATCH_ARG0_NAMESPACE;
+    }
+
+    /* GDBus can't express the whole match as a rule, so it is added to the bus by hand */
+    if (filter_in_process) {
+        flags |= G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE;
+    }
+
+    auto entry = std::make_unique<Rule>(
+        Rule{*this, std::move(key), std::move(rule), match, filter_in_process, 0, {}});
+
+    entry->gio_subscription = g_dbus_connection_signal_subscribe(
+        m_connection,
+        nullable(match.sender),
+        nullable(match.interface),
+        nullable(match.member),
+        nullable(match.object),
+        arg0,
+        static_cast<GDBusSignalFlags>(flags),
+        on_signal,
+        entry.get(),
+        [](void *data) {
+            delete reinterpret_cast<Rule *>(data);
+        });
+
+    if (!entry->gio_subscription) {
+        GIO_DBUS_CPP_THROW_ERROR("Failed to subscribe to signal matching \"" + entry->rule + "\"");
+    }
+
+    /* GDBus owns the rule from now on and deletes it once unsubscribed */
+    Rule *added = entry.release();
+    m_rules.emplace(added->key, added);
+
+    if (filter_in_process && m_rules_added_by_hand[added->rule]++ == 0) {
+        call_bus_match_method("AddMatch", added->rule);
+    }
+
+    return added;
+}
+
+void SignalRegistry::remove_rule(Rule *rule) noexcept
+{
+    m_rules.erase(rule->key);
+
+    if (rule->filter_in_process) {
+        auto added_by_hand = m_rules_added_by_hand.find(rule->rule);
+
+        if (--added_by_hand->second == 0) {
+            call_bus_match_method("RemoveMatch", rule->rule);
+            m_rules_added_by_hand.erase(added_by_hand);
+        }
+    }
+
+    g_dbus_connection_signal_unsubscribe(m_connection, rule->gio_subscription);
+}
+
+/* The reply is not awaited, as GDBus does for the match rules it adds itself. Peer-to-peer
+ * connections have no bus and no unique name, the peer sends them all of its signals. */
+void SignalRegistry::call_bus_match_method(const char *method,
+                                           const std::string &rule) const noexcept
+{
+    if (!g_dbus_connection_get_unique_name(m_connection)) {
+        return;
+    }
+
+    g_dbus_connection_call(m_connection,
+                           "org.freedesktop.DBus",
+                           "/org/freedesktop/DBus",
+                           "org.freedesktop.DBus",
+                           method,
+                           g_variant_new("(s)", rule.c_str()),
+                           nullptr,
+                           G_DBUS_CALL_FLAGS_NONE,
+                           -1,
+                           nullptr,
+                           nullptr,
+                           nullptr);
+}
+
+/* Handlers are called without the lock held, so they may subscribe and unsubscribe */
+void SignalRegistry::on_signal(GDBusConnection *,
+                               const char *sender,
+                               const char *object,
+                               const char *,
+                               const char *signal,
+                               GVariant *parameters,
+                               void *user_data)
+{
+    Rule *rule = reinterpret_cast<Rule *>(user_data);
+
+    if (rule->filter_in_process && !is_matching_in_process(rule->match, object, parameters)) {
+        return;
+    }
+
+    std::vector<std::shared_ptr<Rule::Subscriber>> subscribers;
+
+    {
+        std::lock_guard<std::mutex> lock(rule->registry.m_mutex);
+        subscribers.reserve(rule->subscribers.size());
+
+        for (const auto &[_, subscriber]: rule->subscribers) {
+            subscribers.push_back(subscriber);
+        }
+    }
+
+    for (const auto &subscriber: subscribers) {
+        if (subscriber->active) {
+            subscriber->handler(sender, signal, parameters);
+        }
+    }
+}
+
+} /* namespace Gio::DBus */
@@ -0,0 +1,63 @@
+#ifndef GIO_DBUS_CPP_SIGNAL_REGISTRY_HPP
+#define GIO_DBUS_CPP_SIGNAL_REGISTRY_HPP
+
+#include "signal-match.hpp"
+
+#include <gio/gio.h>
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Gio::DBus {
+
+/*
+ * Signal subscriptions of everything using one GDBusConnection, i.e. of its connections and of
+ * all proxies created on them. Subscriptions with the same match made from the same main context
+ * share one GDBus subscription and one match rule on the bus, removed with the last of them, and
+ * every incoming signal is fanned out to their handlers from that single GDBus callback.
+ */
+class SignalRegistry
+{
+public:
+    using Handler =
+        std::function<void(const char *sender, const char *signal_name, GVariant *parameters)>;
+
+    /* The registry is stored on the connection and lives as long as it */
+    static SignalRegistry &of(GDBusConnection *connection);
+
+    SignalRegistry(const SignalRegistry &) = delete;
+    SignalRegistry &operator=(const SignalRegistry &) = delete;
+
+    size_t subscribe(const SignalMatch &match, Handler handler);
+    void unsubscribe(size_t id) noexcept;
+
+private:
+    struct Rule;
+
+    explicit SignalRegistry(GDBusConnection *connection) noexcept;
+
+    Rule *add_rule(std::string key, std::string rule, const SignalMatch &match);
+    void remove_rule(Rule *rule) noexcept;
+    void call_bus_match_method(const char *method, const std::string &rule) const noexcept;
+
+    static void on_signal(GDBusConnection *connection,
+                          const char *sender,
+                          const char *object,
+                          const char *interface,
+                          const char *signal,
+                          GVariant *parameters,
+                          void *user_data);
+
+    GDBusConnection *m_connection;
+    std::mutex m_mutex;
+    size_t m_next_id = 1;
+    std::unordered_map<std::string, Rule *> m_rules;
+    std::unordered_map<size_t, Rule *> m_subscriptions;
+    std::unordered_map<std::string, size_t> m_rules_added_by_hand;
+};
+
+} /* namespace Gio::DBus */
+
+#endif /* GIO_DBUS_CPP_SIGNAL_REGISTRY_HPP */
@@ -0,0 +1,83 @@
+#include "details/dbus-signature-table.hpp"
+#include "details/dbus-validation.hpp"
+
+#include <array>
+#include <functional>
+#include <mutex>
+
+namespace Gio::DBus::Details {
+
+namespace {
+
+constexpr size_t buckets_count = 1024;
+
+struct Table
+{
+    std::array<std::atomic<const DBusInternedSignature *>, buckets_count> buckets = {};
+    std::mutex insert_mutex;
+};
+
+/* The table is never destroyed, interned signatures stay valid during static destruction */
+Table &table()
+{
+    static Table *table = new Table();
+    return *table;
+}
+
+const DBusInternedSignature *find(const std::atomic<const DBusInternedSignature *> &bucket,
+                                  std::string_view signature,
+                                  size_t hash) noexcept
+{
+    const DBusInternedSignature *entry = bucket.load(std::memory_order_acquire);
+
+    for (; entry; entry = entry->next.load(std::memory_order_acquire)) {
+        if (entry->hash == hash && entry->signature == signature) {
+            return entry;
+        }
+    }
+
+    return nullptr;
+}
+
+GVariant *create_exemplar(const std::string &type)
+{
+    if (!g_variant_type_string_is_valid(type.c_str())) {
+        return nullptr;
+    }
+
+    return g_variant_ref_sink(g_variant_new_from_data(
+        reinterpret_cast<const GVariantType *>(type.c_str()), nullptr, 0, false, nullptr, nullptr));
+}
+
+} /* namespace */
+
+const DBusInternedSignature *DBusSignatureTable::intern(std::string_view signature)
+{
+    const size_t hash = std::hash<std::string_view>()(signature);
+    auto &bucket = table().buckets[hash % buckets_count];
+
+    if (const DBusInternedSignature *entry = find(bucket, signature, hash)) {
+        return entry;
+    }
+
+    if (!dbus_is_signature(signature)) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(table().insert_mutex);
+
+    if (const DBusInternedSignature *entry = find(bucket, signature, hash)) {
+        return entry;
+    }
+
+    auto *entry = new DBusInternedSignature{std::string(signature), hash, nullptr, nullptr, {}};
+    entry->exemplar = create_exemplar(entry->signature);
+    entry->tuple_exemplar = create_exemplar("(" + entry->signature + ")");
+
+    entry->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    bucket.store(entry, std::memory_order_release);
+
+    return entry;
+}
+
+} /* namespace Gio::DBus::Details */